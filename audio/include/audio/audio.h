@@ -1,10 +1,13 @@
 #pragma once
 
 #include "type_defs.h"
+#include <dsp/sample_buffer.h>
+#include <dsp/audio_block.h>
 #include <tuple>
 #include <cmath>
 #include <vector>
 #include <numeric>
+#include <cassert>
 
 namespace audio {
 
@@ -29,6 +32,47 @@ namespace audio {
         return choc::buffer::createInterleavedView(samples, numChannels, numFrames);
     }
 
+    /**
+     * the samples of a choc mono view, no copy
+     */
+    template<typename SampleType>
+    dsp::SampleBufferView<SampleType> toView(const choc::buffer::MonoView<SampleType>& view){
+        const auto it = view.getIterator(0);
+        return { it.sample, view.getNumFrames(), it.stride };
+    }
+
+    /**
+     * one channel of interleaved frames as a strided view, no copy, so filters can run on it in place
+     */
+    template<typename SampleType>
+    dsp::SampleBufferView<SampleType> toView(const choc::buffer::InterleavedView<SampleType>& view, uint32_t channel){
+        assert(channel < view.getNumChannels());
+        const auto it = view.getIterator(channel);
+        return { it.sample, view.getNumFrames(), it.stride };
+    }
+
+    template<typename SampleType>
+    choc::buffer::MonoView<SampleType> toMonoView(dsp::SampleBufferView<SampleType> view){
+        return { { view.data(), static_cast<choc::buffer::SampleCount>(view.stride()) }
+                 , { 1, static_cast<choc::buffer::FrameCount>(view.size()) } };
+    }
+
+    /**
+     * choc's view of the same planar samples, no copy
+     */
+    template<typename SampleType>
+    choc::buffer::ChannelArrayView<SampleType> toChannelArrayView(dsp::AudioBlockView<SampleType> block){
+        const auto first = static_cast<choc::buffer::FrameCount>(block.offset());
+        const auto last = first + static_cast<choc::buffer::FrameCount>(block.numFrames());
+        return choc::buffer::createChannelArrayView(block.channels(), static_cast<choc::buffer::ChannelCount>(block.numChannels()), last)
+                .getFrameRange({ first, last });
+    }
+
+    template<typename SampleType>
+    dsp::AudioBlockView<SampleType> toBlockView(const choc::buffer::ChannelArrayView<SampleType>& view){
+        return { view.data.channels, view.getNumChannels(), view.getNumFrames(), view.data.offset };
+    }
+
     inline Channel2 fcpan(real_t input, real_t t){
         real_t a = t * real_t{0.25} - real_t{0.25};
         real_t b = a - real_t{0.25};
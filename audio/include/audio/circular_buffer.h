@@ -2,10 +2,30 @@
 
 #include <cstdint>
 #include <atomic>
+#include <span>
 #include <vector>
+#include <cassert>
+#include <algorithm>
+#include <dsp/audio_block.h>
 
 namespace audio {
 
+    /**
+     * Contiguous part of a CircularAudioBuffer, split in two where it wraps around the end of the
+     * ring. second is empty unless it wraps.
+     */
+    template<typename SampleType>
+    struct CircularRegion {
+        std::span<SampleType> first{};
+        std::span<SampleType> second{};
+
+        [[nodiscard]]
+        uint32_t size() const { return static_cast<uint32_t>(first.size() + second.size()); }
+
+        [[nodiscard]]
+        bool empty() const { return first.empty() && second.empty(); }
+    };
+
     template<typename SampleType>
     class CircularAudioBuffer{
     public:
@@ -25,6 +45,40 @@ namespace audio {
 
         uint32_t pop(SampleType* outBuffer, uint32_t numSamples);
 
+        /**
+         * interleaves the planar block into frames of numChannels samples as it copies, channels
+         * missing from block are written as silence. returns the number of frames pushed
+         */
+        uint32_t push(dsp::AudioBlockView<const SampleType> block, uint32_t numChannels);
+
+        /**
+         * de-interleaves frames of numChannels samples into the planar block, channels beyond
+         * block.numChannels() are dropped. returns the number of frames popped
+         */
+        uint32_t pop(dsp::AudioBlockView<SampleType> block, uint32_t numChannels);
+
+        /**
+         * free space for up to numSamples samples to be written in place, producer only. Nothing is
+         * visible to the consumer until commitWrite
+         */
+        CircularRegion<SampleType> prepareWrite(uint32_t numSamples);
+
+        /**
+         * publishes the first numSamples samples of the last prepareWrite region
+         */
+        void commitWrite(uint32_t numSamples);
+
+        /**
+         * up to numSamples queued samples to be read in place, consumer only. They stay queued
+         * until commitRead
+         */
+        CircularRegion<const SampleType> prepareRead(uint32_t numSamples) const;
+
+        /**
+         * releases the first numSamples samples of the last prepareRead region
+         */
+        void commitRead(uint32_t numSamples);
+
         void setNum(uint32_t numSamples, bool retainOldestSamples = false);
 
         uint32_t num() const;
@@ -68,42 +122,102 @@ namespace audio {
 
     template<typename SampleType>
     uint32_t CircularAudioBuffer<SampleType>::push(const SampleType *iBuffer, uint32_t numSamples) {
+        const auto region = prepareWrite(numSamples);
+        std::copy_n(iBuffer, region.first.size(), region.first.data());
+        std::copy_n(iBuffer + region.first.size(), region.second.size(), region.second.data());
+        commitWrite(region.size());
 
-        auto destBuffer = m_buffer.data();
-        const auto writeIndex = m_writeCounter.load();
-        const auto readIndex = m_readCounter.load();
+        return region.size();
+    }
+
+    template<typename SampleType>
+    uint32_t CircularAudioBuffer<SampleType>::peek(SampleType *oBuffer, uint32_t numSamples) const {
+        const auto region = prepareRead(numSamples);
+        std::copy(region.first.begin(), region.first.end(), oBuffer);
+        std::copy(region.second.begin(), region.second.end(), oBuffer + region.first.size());
+
+        return region.size();
+    }
+
+    template<typename SampleType>
+    uint32_t CircularAudioBuffer<SampleType>::pop(SampleType *outBuffer, uint32_t numSamples) {
+        auto numSamplesRead = peek(outBuffer, numSamples);
+        commitRead(numSamplesRead);
+        return numSamplesRead;
+    }
 
-        auto numToCopy = std::min(numSamples, remainder());
-        const auto numToWrite = std::min(numToCopy, m_capacity - writeIndex);
-        memcpy(&destBuffer[writeIndex], iBuffer, numToWrite * sizeof(SampleType));
+    template<typename SampleType>
+    uint32_t CircularAudioBuffer<SampleType>::push(dsp::AudioBlockView<const SampleType> block, uint32_t numChannels) {
+        auto destBuffer = m_buffer.data();
+        auto writeIndex = m_writeCounter.load();
 
-        memcpy(&destBuffer[0], &iBuffer[numToWrite], (numToCopy - numToWrite) * sizeof(SampleType));
+        const auto numFrames = std::min(static_cast<uint32_t>(block.numFrames()), remainder() / numChannels);
+        const auto channels = block.channels();
+        const auto offset = block.offset();
+        const auto numBlockChannels = static_cast<uint32_t>(block.numChannels());
 
-        m_writeCounter.store((writeIndex + numToCopy) % m_capacity);
+        for(uint32_t frame = 0; frame < numFrames; frame++){
+            for(uint32_t c = 0; c < numChannels; c++){
+                destBuffer[writeIndex] = c < numBlockChannels ? channels[c][offset + frame] : SampleType{};
+                writeIndex = writeIndex + 1 == m_capacity ? 0 : writeIndex + 1;
+            }
+        }
+        m_writeCounter.store(writeIndex);
 
-        return numToCopy;
+        return numFrames;
     }
 
     template<typename SampleType>
-    uint32_t CircularAudioBuffer<SampleType>::peek(SampleType *oBuffer, uint32_t numSamples) const {
+    uint32_t CircularAudioBuffer<SampleType>::pop(dsp::AudioBlockView<SampleType> block, uint32_t numChannels) {
         auto srcBuffer = m_buffer.data();
-        const auto readIndex = m_readCounter.load();
+        auto readIndex = m_readCounter.load();
+
+        const auto numFrames = std::min(static_cast<uint32_t>(block.numFrames()), num() / numChannels);
+        const auto channels = block.channels();
+        const auto offset = block.offset();
+        const auto numBlockChannels = static_cast<uint32_t>(block.numChannels());
+
+        for(uint32_t frame = 0; frame < numFrames; frame++){
+            for(uint32_t c = 0; c < numChannels; c++){
+                if(c < numBlockChannels){
+                    channels[c][offset + frame] = srcBuffer[readIndex];
+                }
+                readIndex = readIndex + 1 == m_capacity ? 0 : readIndex + 1;
+            }
+        }
+        m_readCounter.store(readIndex);
+
+        return numFrames;
+    }
+
+    template<typename SampleType>
+    CircularRegion<SampleType> CircularAudioBuffer<SampleType>::prepareWrite(uint32_t numSamples) {
         const auto writeIndex = m_writeCounter.load();
+        const auto size = std::min(numSamples, remainder());
+        const auto firstSize = std::min(size, m_capacity - writeIndex);
+
+        return { { m_buffer.data() + writeIndex, firstSize }, { m_buffer.data(), size - firstSize } };
+    }
 
-        auto numToCopy = std::min(numSamples, num());
-        const auto numRead = std::min(numToCopy, m_capacity - readIndex);
-        memcpy(oBuffer, &srcBuffer[readIndex], numRead * sizeof(SampleType));
+    template<typename SampleType>
+    void CircularAudioBuffer<SampleType>::commitWrite(uint32_t numSamples) {
+        assert(numSamples <= remainder());
+        m_writeCounter.store((m_writeCounter.load() + numSamples) % m_capacity);
+    }
 
-        memcpy(&oBuffer[numRead], &srcBuffer[0], (numToCopy - numRead) * sizeof(SampleType));
+    template<typename SampleType>
+    CircularRegion<const SampleType> CircularAudioBuffer<SampleType>::prepareRead(uint32_t numSamples) const {
+        const auto readIndex = m_readCounter.load();
+        const auto size = std::min(numSamples, num());
+        const auto firstSize = std::min(size, m_capacity - readIndex);
 
-        return numToCopy;
+        return { { m_buffer.data() + readIndex, firstSize }, { m_buffer.data(), size - firstSize } };
     }
 
     template<typename SampleType>
-    uint32_t CircularAudioBuffer<SampleType>::pop(SampleType *outBuffer, uint32_t numSamples) {
-        auto numSamplesRead = peek(outBuffer, numSamples);
-        m_readCounter.store((m_readCounter.load() + numSamplesRead) % m_capacity);
-        return numSamplesRead;
+    void CircularAudioBuffer<SampleType>::commitRead(uint32_t numSamples) {
+        assert(numSamples <= num());
+        m_readCounter.store((m_readCounter.load() + numSamples) % m_capacity);
     }
 
     template<typename SampleType>
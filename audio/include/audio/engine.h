@@ -10,6 +10,7 @@
 #include "patch.h"
 #include <iostream>
 #include "audio.h"
+#include <dsp/denormal.h>
 
 #define ERR_GUARD_PA(err) \
 if((err) != paNoError) {    \
@@ -146,20 +147,13 @@ namespace audio {
     void Engine::writeToDevice(float *out) {
         requestAudioData.notify_one();
 
+        // the only copy on the way out, straight from the ring into the device buffer
         const auto size = m_format.frameBufferSize * m_format.outputChannels;
-        std::fill_n(out, size, 0.f);
-        static std::vector<real_t> bucket(size);
-
-        auto read = m_outputBuffer.pop(bucket.data(), size);
-
-        auto in = bucket.data();
-
-        for(int i = 0; i < read; i += m_format.outputChannels){
-            for(int c = 0; c < m_format.outputChannels; ++c){
-                *out = *in;
-                ++in, ++out;
-            }
-        }
+        const auto region = m_outputBuffer.prepareRead(size);
+        out = std::copy(region.first.begin(), region.first.end(), out);
+        out = std::copy(region.second.begin(), region.second.end(), out);
+        std::fill_n(out, size - region.size(), 0.f);
+        m_outputBuffer.commitRead(region.size());
     }
 
     void Engine::readFromDevice(const float *in) {
@@ -181,6 +175,7 @@ namespace audio {
 
     int Engine::callback(const void *inputBuffer, void *outputBuffer, unsigned long frameCount,
                          const PaStreamCallbackTimeInfo *timeInfo, PaStreamCallbackFlags statusFlags, void *userData) {
+        dsp::ScopedNoDenormals noDenormals;
         auto& engine = *reinterpret_cast<Engine*>(userData);
         if(engine.m_format.inputChannels != 0){
             engine.readFromDevice(reinterpret_cast<const float*>(inputBuffer));
@@ -206,8 +201,7 @@ namespace audio {
     }
 
     void Engine::update() {
-        static std::vector<float> buffer{};
-        static int32_t read = 0;
+        dsp::ScopedNoDenormals noDenormals;
 
         while(true){
             std::unique_lock<std::mutex> lock{ m_mutex };
@@ -219,17 +213,25 @@ namespace audio {
 
             if (available > 0) {
                 auto readSize = std::min(as<int32_t>(m_outputBuffer.remainder()), (available));
-                buffer.resize(readSize);
 
                 if(readSize%m_format.outputChannels != 0) {
                     std::cout << "invalid readSize: " << readSize << "\n";
                     assert(readSize%m_format.outputChannels == 0);
                 }
 
-                read = m_mixer.popAudio(buffer.data(), readSize, false);
+                // the mixer sums its inputs directly into the output ring
+                const auto region = m_outputBuffer.prepareWrite(readSize);
+                auto read = m_mixer.popAudio(region.first.data(), as<int32_t>(region.first.size()), false);
+                if(read == as<int32_t>(region.first.size()) && !region.second.empty()){
+                    read += std::max(0, m_mixer.popAudio(region.second.data(), as<int32_t>(region.second.size()), false));
+                }
+                read = std::max(0, read);
 
-                m_outputBuffer.push(buffer.data(), read);
-                m_tap.pushAudio(buffer.data(), read);
+                m_tap.pushAudio(region.first.data(), std::min(read, as<int32_t>(region.first.size())));
+                if(read > as<int32_t>(region.first.size())){
+                    m_tap.pushAudio(region.second.data(), read - as<int32_t>(region.first.size()));
+                }
+                m_outputBuffer.commitWrite(read);
             }
 
         }
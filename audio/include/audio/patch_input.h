@@ -33,6 +33,11 @@ namespace audio {
 
         int32_t pushAudio(const InterleavedView& buffer);
 
+        /**
+         * interleaves the planar block straight into the patch, returns the number of frames pushed
+         */
+        int32_t pushAudio(dsp::AudioBlockView<const real_t> block);
+
         void gain(float value);
 
         [[nodiscard]]
@@ -47,6 +52,12 @@ namespace audio {
     private:
         int32_t pushAudio(const float* inBuffer, uint32_t numSamples);
 
+        /**
+         * interleaves strided channels, e.g. channels of another interleaved buffer, straight into
+         * the patch. right is dropped on mono patches, returns the number of frames pushed
+         */
+        int32_t pushAudio(dsp::SampleBufferView<const real_t> left, dsp::SampleBufferView<const real_t> right);
+
     private:
        PatchOutputWeakPtr m_outputHandle{};
        uint32_t m_pushCallsCounter{0};
@@ -83,8 +94,8 @@ namespace audio {
     }
 
     int32_t PatchInput::pushAudio(float left, float right) {
-        auto pushed = pushAudio(&left, 1u) + pushAudio(&right, 1u);
-        return pushed/2;
+        const real_t* channels[]{ &left, &right };
+        return pushAudio(dsp::AudioBlockView<const real_t>{ channels, 2, 1 });
     }
 
     int32_t PatchInput::pushAudio(float sample) {
@@ -93,7 +104,7 @@ namespace audio {
 
     int32_t PatchInput::pushAudio(const MonoView& buffer) {
         if(auto outPtr = m_outputHandle.lock()){
-            if(outPtr->m_info.outputChannels() == 1){
+            if(outPtr->m_info.outputChannels() == 1 && buffer.data.stride == 1){
                 return pushAudio(buffer.data.data, buffer.size.numFrames);
             }else {
                 return pushAudio(buffer, buffer);
@@ -103,22 +114,12 @@ namespace audio {
     }
 
     int32_t PatchInput::pushAudio(const MonoView &left, const MonoView &right) {
-        // TODO check we support stereo
-        if(auto outPtr = m_outputHandle.lock()){
-            auto numChannels = outPtr->m_info.outputChannels();
-            auto numFrames = std::max(left.size.numFrames, right.size.numFrames);
-            auto size = numChannels * numFrames;
-            std::vector<real_t> data(size);
-            for(auto i = 0; i < numFrames; i++){
-                data[i * numChannels] = left.getSample(0, i);
-                data[i * numChannels + 1] = right.getSample(0, i);
-            }
-            auto interleaved = audio::wrapInterLeaved(data.data(), numChannels, numFrames);
-
-            return pushAudio(interleaved);
+        if(left.data.stride != 1 || right.data.stride != 1){
+            return pushAudio(toView(left), toView(right));
         }
-        return -1;
-
+        const real_t* channels[]{ left.data.data, right.data.data };
+        const auto numFrames = std::min(left.size.numFrames, right.size.numFrames);
+        return pushAudio(dsp::AudioBlockView<const real_t>{ channels, 2, numFrames });
     }
 
     int32_t PatchInput::pushAudio(const InterleavedView& buffer) {
@@ -128,6 +129,37 @@ namespace audio {
         return pushAudio(samples, numSamples)/buffer.size.numChannels;
     }
 
+    int32_t PatchInput::pushAudio(dsp::AudioBlockView<const real_t> block) {
+        auto output = m_outputHandle.lock();
+        if(!output){
+            return -1;
+        }
+        return as<int32_t>(output->m_buffer.push(block, output->m_info.outputChannels()));
+    }
+
+    int32_t PatchInput::pushAudio(dsp::SampleBufferView<const real_t> left, dsp::SampleBufferView<const real_t> right) {
+        auto output = m_outputHandle.lock();
+        if(!output){
+            return -1;
+        }
+
+        auto& buffer = output->m_buffer;
+        const auto numChannels = as<uint32_t>(output->m_info.outputChannels());
+        const auto numFrames = std::min({ as<uint32_t>(left.size()), as<uint32_t>(right.size()), buffer.remainder() / numChannels });
+
+        const auto region = buffer.prepareWrite(numFrames * numChannels);
+        const auto split = as<uint32_t>(region.first.size());
+        for(uint32_t frame = 0, i = 0; frame < numFrames; frame++){
+            for(uint32_t c = 0; c < numChannels; c++, i++){
+                const auto sample = c == 0 ? left[frame] : c == 1 ? right[frame] : real_t{};
+                (i < split ? region.first[i] : region.second[i - split]) = sample;
+            }
+        }
+        buffer.commitWrite(region.size());
+
+        return as<int32_t>(numFrames);
+    }
+
     int32_t PatchInput::pushAudio(const real_t *inBuffer, uint32_t numSamples) {
         auto output = m_outputHandle.lock();
         if(!output){
@@ -18,6 +18,11 @@ namespace audio {
 
         int32_t popAudio(real_t *OutBuffer, uint32_t numSamples, bool useLatestAudio);
 
+        /**
+         * de-interleaves into the planar block, returns the number of frames popped
+         */
+        int32_t popAudio(dsp::AudioBlockView<real_t> block, bool useLatestAudio);
+
         int32_t mixInAudio(real_t *outBuffer, uint32_t numSamples, bool useLatestAudio);
 
         size_t getNumSamplesAvailable() const;
@@ -34,7 +39,6 @@ namespace audio {
 
     private:
         CircularAudioBuffer<real_t> m_buffer{};
-        std::vector<real_t> m_mixingBuffer{};
         std::atomic<real_t> m_targetGain{0.0};
         std::atomic<int32_t> m_numAliveInputs{0};
         Info m_info;
@@ -64,23 +68,40 @@ namespace audio {
         return numPopped;
     }
 
-    int32_t PatchOutput::mixInAudio(real_t *outBuffer, uint32_t numSamples, bool useLatestAudio) {
+    int32_t PatchOutput::popAudio(dsp::AudioBlockView<real_t> block, bool useLatestAudio) {
         if(isInputStale()){
             return -1;
         }
-        m_mixingBuffer.resize(numSamples);
-        int32_t popResult{};
 
+        const auto numChannels = as<uint32_t>(m_info.outputChannels());
+        const auto numSamples = as<uint32_t>(block.numFrames()) * numChannels;
         if(useLatestAudio && m_buffer.num() > numSamples){
             m_buffer.setNum(numSamples);
-            popResult = as<int32_t>(m_buffer.peek(m_mixingBuffer.data(), numSamples));
-        }else{
-            popResult = as<int32_t>(m_buffer.pop(m_mixingBuffer.data(), numSamples));
         }
 
-        mixInBuffer(m_mixingBuffer.data(), outBuffer, popResult, m_targetGain);
+        return as<int32_t>(m_buffer.pop(block, numChannels));
+    }
+
+    int32_t PatchOutput::mixInAudio(real_t *outBuffer, uint32_t numSamples, bool useLatestAudio) {
+        if(isInputStale()){
+            return -1;
+        }
+        // mixed straight out of the ring, latest audio is only peeked at and stays queued
+        const auto peekOnly = useLatestAudio && m_buffer.num() > numSamples;
+        if(peekOnly){
+            m_buffer.setNum(numSamples);
+        }
+
+        const auto region = m_buffer.prepareRead(numSamples);
+        const auto gain = m_targetGain.load();
+        mixInBuffer(region.first.data(), outBuffer, as<uint32_t>(region.first.size()), gain);
+        mixInBuffer(region.second.data(), outBuffer + region.first.size(), as<uint32_t>(region.second.size()), gain);
+
+        if(!peekOnly){
+            m_buffer.commitRead(region.size());
+        }
 
-        return popResult;
+        return as<int32_t>(region.size());
     }
 
     void PatchOutput::mixInBuffer(const real_t *inBuffer, float *bufferToSumTo, uint32_t numSamples, float gain) {
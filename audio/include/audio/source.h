@@ -3,6 +3,7 @@
 #include "audio.h"
 #include "circular_buffer.h"
 #include "patch_input.h"
+#include <dsp/denormal.h>
 #include <thread>
 #include <span>
 
@@ -24,6 +25,7 @@ namespace audio {
 
         void play() {
             std::thread thread{ [&]{
+                dsp::ScopedNoDenormals noDenormals;
                 isRunning = true;
 
                 audio::CircularAudioBuffer<float> buffer(1024);
@@ -90,6 +92,7 @@ namespace audio {
         }
     private:
         void play0() {
+            dsp::ScopedNoDenormals noDenormals;
             isRunning = true;
 
             uint32_t capacity =  m_source.size();
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <new>
+#include <limits>
+#include <cstddef>
+#include <memory_resource>
+
+namespace dsp {
+
+    inline constexpr size_t CacheLineSize = 64;
+
+    /**
+     * Allocates memory aligned to Alignment bytes, by default a cache line, which also covers
+     * aligned SIMD loads up to 512 bits wide
+     */
+    template<typename T, size_t Alignment = CacheLineSize>
+    class AlignedAllocator {
+    public:
+        static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0, "Alignment should be a power of two no smaller than alignof(T)");
+
+        using value_type = T;
+
+        template<typename U>
+        struct rebind {
+            using other = AlignedAllocator<U, Alignment>;
+        };
+
+        AlignedAllocator() noexcept = default;
+
+        template<typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(size_t n);
+
+        void deallocate(T* p, size_t n) noexcept;
+
+        template<typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    };
+
+    namespace pmr {
+
+        /**
+         * Polymorphic allocator that keeps the Alignment guarantee, memory comes from the
+         * memory_resource it was constructed with (the default resource otherwise), so buffers
+         * can live in a pool or an arena. Like std::pmr::polymorphic_allocator, the resource
+         * is not propagated on copy, copies use the default resource.
+         */
+        template<typename T, size_t Alignment = CacheLineSize>
+        class AlignedAllocator {
+        public:
+            using value_type = T;
+
+            template<typename U>
+            struct rebind {
+                using other = AlignedAllocator<U, Alignment>;
+            };
+
+            AlignedAllocator() noexcept;
+
+            AlignedAllocator(std::pmr::memory_resource* resource) noexcept;
+
+            template<typename U>
+            AlignedAllocator(const AlignedAllocator<U, Alignment>& other) noexcept;
+
+            T* allocate(size_t n);
+
+            void deallocate(T* p, size_t n) noexcept;
+
+            AlignedAllocator select_on_container_copy_construction() const;
+
+            [[nodiscard]]
+            std::pmr::memory_resource* resource() const noexcept;
+
+            template<typename U>
+            bool operator==(const AlignedAllocator<U, Alignment>& other) const noexcept;
+
+        private:
+            std::pmr::memory_resource* m_resource;
+        };
+
+        /**
+         * pool owned by the calling thread for short lived buffers, not thread safe, memory from it
+         * should be released on the thread that allocated it
+         */
+        std::pmr::memory_resource* threadArena();
+    }
+
+    template<typename T, size_t Alignment>
+    T* AlignedAllocator<T, Alignment>::allocate(size_t n) {
+        if(n > std::numeric_limits<size_t>::max() / sizeof(T)){
+            throw std::bad_array_new_length{};
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{ Alignment }));
+    }
+
+    template<typename T, size_t Alignment>
+    void AlignedAllocator<T, Alignment>::deallocate(T *p, size_t n) noexcept {
+        ::operator delete(p, n * sizeof(T), std::align_val_t{ Alignment });
+    }
+
+    namespace pmr {
+
+        template<typename T, size_t Alignment>
+        AlignedAllocator<T, Alignment>::AlignedAllocator() noexcept
+        : m_resource{ std::pmr::get_default_resource() }
+        {}
+
+        template<typename T, size_t Alignment>
+        AlignedAllocator<T, Alignment>::AlignedAllocator(std::pmr::memory_resource *resource) noexcept
+        : m_resource{ resource }
+        {}
+
+        template<typename T, size_t Alignment>
+        template<typename U>
+        AlignedAllocator<T, Alignment>::AlignedAllocator(const AlignedAllocator<U, Alignment> &other) noexcept
+        : m_resource{ other.resource() }
+        {}
+
+        template<typename T, size_t Alignment>
+        T* AlignedAllocator<T, Alignment>::allocate(size_t n) {
+            if(n > std::numeric_limits<size_t>::max() / sizeof(T)){
+                throw std::bad_array_new_length{};
+            }
+            return static_cast<T*>(m_resource->allocate(n * sizeof(T), Alignment));
+        }
+
+        template<typename T, size_t Alignment>
+        void AlignedAllocator<T, Alignment>::deallocate(T *p, size_t n) noexcept {
+            m_resource->deallocate(p, n * sizeof(T), Alignment);
+        }
+
+        template<typename T, size_t Alignment>
+        AlignedAllocator<T, Alignment> AlignedAllocator<T, Alignment>::select_on_container_copy_construction() const {
+            return AlignedAllocator{};
+        }
+
+        template<typename T, size_t Alignment>
+        std::pmr::memory_resource* AlignedAllocator<T, Alignment>::resource() const noexcept {
+            return m_resource;
+        }
+
+        template<typename T, size_t Alignment>
+        template<typename U>
+        bool AlignedAllocator<T, Alignment>::operator==(const AlignedAllocator<U, Alignment> &other) const noexcept {
+            return m_resource == other.resource() || m_resource->is_equal(*other.resource());
+        }
+
+        inline std::pmr::memory_resource* threadArena() {
+            thread_local std::pmr::unsynchronized_pool_resource arena{};
+            return &arena;
+        }
+    }
+}
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include "allocator.h"
+#include "sample_buffer.h"
+
+namespace dsp {
+
+    /**
+     * Non owning view of numFrames frames of planar audio, channel c is channels[c] + offset.
+     * Copying a view copies four words, frames() and channelRange() narrow it without touching
+     * the samples. SampleType may be const for read only views, mutable views convert to them.
+     */
+    template<typename SampleType>
+    class AudioBlockView {
+    public:
+        using value_type = std::remove_const_t<SampleType>;
+
+        AudioBlockView() = default;
+
+        AudioBlockView(SampleType* const* channels, size_t numChannels, size_t numFrames, size_t offset = 0);
+
+        template<typename Other>
+        AudioBlockView(const AudioBlockView<Other>& other) requires std::is_same_v<const Other, SampleType> && (!std::is_same_v<Other, SampleType>);
+
+        [[nodiscard]]
+        size_t numChannels() const noexcept;
+
+        [[nodiscard]]
+        size_t numFrames() const noexcept;
+
+        /**
+         * first frame of every channel pointer, channels()[c] + offset() is the start of channel c
+         */
+        [[nodiscard]]
+        size_t offset() const noexcept;
+
+        [[nodiscard]]
+        bool empty() const noexcept;
+
+        [[nodiscard]]
+        SampleType* const* channels() const noexcept;
+
+        [[nodiscard]]
+        SampleBufferView<SampleType> channel(size_t index) const;
+
+        SampleBufferView<SampleType> operator[](size_t index) const;
+
+        [[nodiscard]]
+        SampleType& sample(size_t channel, size_t frame) const;
+
+        /**
+         * count frames starting at offset, in frames of this view
+         */
+        [[nodiscard]]
+        AudioBlockView frames(size_t offset, size_t count) const;
+
+        /**
+         * count channels starting at first
+         */
+        [[nodiscard]]
+        AudioBlockView channelRange(size_t first, size_t count) const;
+
+        void clear() const requires (!std::is_const_v<SampleType>);
+
+    private:
+        SampleType* const* m_channels{nullptr};
+        size_t m_numChannels{0};
+        size_t m_numFrames{0};
+        size_t m_offset{0};
+    };
+
+    /**
+     * Planar multichannel audio in one allocation, every channel starts on a cache line so each
+     * can be handed to SIMD loops and filters as is. channel(c) is a SampleBufferView, view() an
+     * AudioBlockView, neither copies samples.
+     */
+    template<typename SampleType, typename Allocator = AlignedAllocator<SampleType>>
+    class AudioBlock {
+    public:
+        AudioBlock() = default;
+
+        AudioBlock(size_t numChannels, size_t numFrames, const Allocator& allocator = Allocator{});
+
+        AudioBlock(const AudioBlock& other);
+
+        AudioBlock(AudioBlock&& other) noexcept = default;
+
+        AudioBlock& operator=(const AudioBlock& other);
+
+        AudioBlock& operator=(AudioBlock&& other) noexcept;
+
+        /**
+         * samples are zeroed, storage is only reallocated when it grows
+         */
+        void resize(size_t numChannels, size_t numFrames);
+
+        [[nodiscard]]
+        size_t numChannels() const noexcept;
+
+        [[nodiscard]]
+        size_t numFrames() const noexcept;
+
+        /**
+         * samples from the start of one channel to the start of the next
+         */
+        [[nodiscard]]
+        size_t channelStride() const noexcept;
+
+        [[nodiscard]]
+        SampleType* const* channels() noexcept;
+
+        [[nodiscard]]
+        const SampleType* const* channels() const noexcept;
+
+        [[nodiscard]]
+        SampleBufferView<SampleType> channel(size_t index);
+
+        [[nodiscard]]
+        SampleBufferView<const SampleType> channel(size_t index) const;
+
+        SampleBufferView<SampleType> operator[](size_t index);
+
+        SampleBufferView<const SampleType> operator[](size_t index) const;
+
+        [[nodiscard]]
+        AudioBlockView<SampleType> view() noexcept;
+
+        [[nodiscard]]
+        AudioBlockView<const SampleType> view() const noexcept;
+
+        operator AudioBlockView<SampleType>() noexcept;
+
+        operator AudioBlockView<const SampleType>() const noexcept;
+
+        void clear();
+
+    private:
+        void layout();
+
+    private:
+        std::vector<SampleType, Allocator> m_samples;
+        std::vector<SampleType*> m_channels;
+        size_t m_numFrames{0};
+        size_t m_channelStride{0};
+    };
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    template<typename SampleType>
+    AudioBlockView<SampleType>::AudioBlockView(SampleType *const *channels, size_t numChannels, size_t numFrames, size_t offset)
+            : m_channels{ channels }
+            , m_numChannels{ numChannels }
+            , m_numFrames{ numFrames }
+            , m_offset{ offset }
+    {}
+
+    template<typename SampleType>
+    template<typename Other>
+    AudioBlockView<SampleType>::AudioBlockView(const AudioBlockView<Other> &other) requires std::is_same_v<const Other, SampleType> && (!std::is_same_v<Other, SampleType>)
+            : m_channels{ other.channels() }
+            , m_numChannels{ other.numChannels() }
+            , m_numFrames{ other.numFrames() }
+            , m_offset{ other.offset() }
+    {}
+
+    template<typename SampleType>
+    size_t AudioBlockView<SampleType>::numChannels() const noexcept {
+        return m_numChannels;
+    }
+
+    template<typename SampleType>
+    size_t AudioBlockView<SampleType>::numFrames() const noexcept {
+        return m_numFrames;
+    }
+
+    template<typename SampleType>
+    size_t AudioBlockView<SampleType>::offset() const noexcept {
+        return m_offset;
+    }
+
+    template<typename SampleType>
+    bool AudioBlockView<SampleType>::empty() const noexcept {
+        return m_numChannels == 0 || m_numFrames == 0;
+    }
+
+    template<typename SampleType>
+    SampleType* const* AudioBlockView<SampleType>::channels() const noexcept {
+        return m_channels;
+    }
+
+    template<typename SampleType>
+    SampleBufferView<SampleType> AudioBlockView<SampleType>::channel(size_t index) const {
+        assert(index < m_numChannels);
+        return { m_channels[index] + m_offset, m_numFrames };
+    }
+
+    template<typename SampleType>
+    SampleBufferView<SampleType> AudioBlockView<SampleType>::operator[](size_t index) const {
+        return channel(index);
+    }
+
+    template<typename SampleType>
+    SampleType& AudioBlockView<SampleType>::sample(size_t channel, size_t frame) const {
+        assert(channel < m_numChannels && frame < m_numFrames);
+        return m_channels[channel][m_offset + frame];
+    }
+
+    template<typename SampleType>
+    AudioBlockView<SampleType> AudioBlockView<SampleType>::frames(size_t offset, size_t count) const {
+        assert(offset + count <= m_numFrames);
+        return { m_channels, m_numChannels, count, m_offset + offset };
+    }
+
+    template<typename SampleType>
+    AudioBlockView<SampleType> AudioBlockView<SampleType>::channelRange(size_t first, size_t count) const {
+        assert(first + count <= m_numChannels);
+        return { m_channels + first, count, m_numFrames, m_offset };
+    }
+
+    template<typename SampleType>
+    void AudioBlockView<SampleType>::clear() const requires (!std::is_const_v<SampleType>) {
+        for(size_t c = 0; c < m_numChannels; c++){
+            std::fill_n(m_channels[c] + m_offset, m_numFrames, SampleType{});
+        }
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlock<SampleType, Allocator>::AudioBlock(size_t numChannels, size_t numFrames, const Allocator &allocator)
+            : m_samples(allocator)
+    {
+        resize(numChannels, numFrames);
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlock<SampleType, Allocator>::AudioBlock(const AudioBlock &other)
+            : m_samples{ other.m_samples }
+            , m_channels(other.m_channels.size())
+            , m_numFrames{ other.m_numFrames }
+            , m_channelStride{ other.m_channelStride }
+    {
+        layout();
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlock<SampleType, Allocator>& AudioBlock<SampleType, Allocator>::operator=(const AudioBlock &other) {
+        if(this != &other){
+            m_samples = other.m_samples;
+            m_channels.resize(other.m_channels.size());
+            m_numFrames = other.m_numFrames;
+            m_channelStride = other.m_channelStride;
+            layout();
+        }
+        return *this;
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlock<SampleType, Allocator>& AudioBlock<SampleType, Allocator>::operator=(AudioBlock &&other) noexcept {
+        // an allocator that doesn't propagate on move may copy the samples, so the pointers are rebuilt
+        m_samples = std::move(other.m_samples);
+        m_channels = std::move(other.m_channels);
+        m_numFrames = std::exchange(other.m_numFrames, 0);
+        m_channelStride = std::exchange(other.m_channelStride, 0);
+        layout();
+        return *this;
+    }
+
+    template<typename SampleType, typename Allocator>
+    void AudioBlock<SampleType, Allocator>::resize(size_t numChannels, size_t numFrames) {
+        // channels padded to whole cache lines so every one of them starts aligned
+        constexpr auto LineSamples = std::max<size_t>(1, CacheLineSize / sizeof(SampleType));
+        m_numFrames = numFrames;
+        m_channelStride = (numFrames + LineSamples - 1) / LineSamples * LineSamples;
+
+        m_samples.assign(numChannels * m_channelStride, SampleType{});
+        m_channels.resize(numChannels);
+        layout();
+    }
+
+    template<typename SampleType, typename Allocator>
+    void AudioBlock<SampleType, Allocator>::layout() {
+        for(size_t c = 0; c < m_channels.size(); c++){
+            m_channels[c] = m_samples.data() + c * m_channelStride;
+        }
+    }
+
+    template<typename SampleType, typename Allocator>
+    size_t AudioBlock<SampleType, Allocator>::numChannels() const noexcept {
+        return m_channels.size();
+    }
+
+    template<typename SampleType, typename Allocator>
+    size_t AudioBlock<SampleType, Allocator>::numFrames() const noexcept {
+        return m_numFrames;
+    }
+
+    template<typename SampleType, typename Allocator>
+    size_t AudioBlock<SampleType, Allocator>::channelStride() const noexcept {
+        return m_channelStride;
+    }
+
+    template<typename SampleType, typename Allocator>
+    SampleType* const* AudioBlock<SampleType, Allocator>::channels() noexcept {
+        return m_channels.data();
+    }
+
+    template<typename SampleType, typename Allocator>
+    const SampleType* const* AudioBlock<SampleType, Allocator>::channels() const noexcept {
+        return m_channels.data();
+    }
+
+    template<typename SampleType, typename Allocator>
+    SampleBufferView<SampleType> AudioBlock<SampleType, Allocator>::channel(size_t index) {
+        return view().channel(index);
+    }
+
+    template<typename SampleType, typename Allocator>
+    SampleBufferView<const SampleType> AudioBlock<SampleType, Allocator>::channel(size_t index) const {
+        return view().channel(index);
+    }
+
+    template<typename SampleType, typename Allocator>
+    SampleBufferView<SampleType> AudioBlock<SampleType, Allocator>::operator[](size_t index) {
+        return channel(index);
+    }
+
+    template<typename SampleType, typename Allocator>
+    SampleBufferView<const SampleType> AudioBlock<SampleType, Allocator>::operator[](size_t index) const {
+        return channel(index);
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlockView<SampleType> AudioBlock<SampleType, Allocator>::view() noexcept {
+        return { m_channels.data(), m_channels.size(), m_numFrames };
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlockView<const SampleType> AudioBlock<SampleType, Allocator>::view() const noexcept {
+        return { channels(), m_channels.size(), m_numFrames };
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlock<SampleType, Allocator>::operator AudioBlockView<SampleType>() noexcept {
+        return view();
+    }
+
+    template<typename SampleType, typename Allocator>
+    AudioBlock<SampleType, Allocator>::operator AudioBlockView<const SampleType>() const noexcept {
+        return view();
+    }
+
+    template<typename SampleType, typename Allocator>
+    void AudioBlock<SampleType, Allocator>::clear() {
+        std::fill(m_samples.begin(), m_samples.end(), SampleType{});
+    }
+}
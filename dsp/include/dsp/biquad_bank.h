@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include "coefficients.h"
+#include "denormal.h"
+
+namespace dsp {
+
+    /**
+     * Runs Lanes independent biquads side by side, one channel per SIMD lane.
+     * Coefficients and state are kept as structure of arrays, so each step of
+     * the recurrence is a handful of full width vector operations across all
+     * channels and the serial dependency of a single biquad is hidden by the
+     * channels running in parallel.
+     */
+    template<typename SampleType, size_t Lanes>
+    class BiQuadBank {
+    public:
+        static_assert(Lanes == 4 || Lanes == 8 || Lanes == 16, "Lanes should be 4, 8 or 16");
+        static_assert(std::is_floating_point_v<SampleType>, "SampleType should be floating point type");
+
+        BiQuadBank() = default;
+
+        template<typename Real>
+        explicit BiQuadBank(const Coefficients<2, Real>& biQuad);
+
+        template<typename Real>
+        void set(const Coefficients<2, Real>& biQuad);
+
+        template<typename Real>
+        void set(size_t lane, const Coefficients<2, Real>& biQuad);
+
+        /**
+         * input and output hold numFrames frames of Lanes interleaved samples
+         */
+        void process(const SampleType* input, SampleType* output, size_t numFrames);
+
+        /**
+         * one planar buffer of numFrames samples per lane
+         */
+        void process(const std::array<const SampleType*, Lanes>& input, const std::array<SampleType*, Lanes>& output, size_t numFrames);
+
+        void reset();
+
+        static constexpr size_t lanes = Lanes;
+
+    private:
+        template<typename Load, typename Store>
+        void run(size_t numFrames, Load&& load, Store&& store);
+
+    private:
+        using Lane = std::array<SampleType, Lanes>;
+
+        alignas(64) Lane m_a0{};
+        alignas(64) Lane m_a1{};
+        alignas(64) Lane m_a2{};
+        alignas(64) Lane m_b1{};
+        alignas(64) Lane m_b2{};
+        alignas(64) Lane m_c0{};
+        alignas(64) Lane m_d0{};
+
+        alignas(64) Lane m_x1{};
+        alignas(64) Lane m_x2{};
+        alignas(64) Lane m_y1{};
+        alignas(64) Lane m_y2{};
+    };
+
+    template<typename SampleType, size_t Lanes>
+    template<typename Real>
+    BiQuadBank<SampleType, Lanes>::BiQuadBank(const Coefficients<2, Real> &biQuad) {
+        set(biQuad);
+    }
+
+    template<typename SampleType, size_t Lanes>
+    template<typename Real>
+    void BiQuadBank<SampleType, Lanes>::set(const Coefficients<2, Real> &biQuad) {
+        for(size_t lane = 0; lane < Lanes; lane++){
+            set(lane, biQuad);
+        }
+    }
+
+    template<typename SampleType, size_t Lanes>
+    template<typename Real>
+    void BiQuadBank<SampleType, Lanes>::set(size_t lane, const Coefficients<2, Real> &biQuad) {
+        assert(lane < Lanes);
+        m_a0[lane] = static_cast<SampleType>(biQuad.a[0]);
+        m_a1[lane] = static_cast<SampleType>(biQuad.a[1]);
+        m_a2[lane] = static_cast<SampleType>(biQuad.a[2]);
+        m_b1[lane] = static_cast<SampleType>(biQuad.b[1]);
+        m_b2[lane] = static_cast<SampleType>(biQuad.b[2]);
+        m_c0[lane] = static_cast<SampleType>(biQuad.c0);
+        m_d0[lane] = static_cast<SampleType>(biQuad.d0);
+    }
+
+    template<typename SampleType, size_t Lanes>
+    template<typename Load, typename Store>
+    void BiQuadBank<SampleType, Lanes>::run(size_t numFrames, Load&& load, Store&& store) {
+        // local copies, stores to the caller's output can then never alias the bank
+        const auto a0 = m_a0, a1 = m_a1, a2 = m_a2;
+        const auto b1 = m_b1, b2 = m_b2;
+        const auto c0 = m_c0, d0 = m_d0;
+        auto x1 = m_x1, x2 = m_x2;
+        auto y1 = m_y1, y2 = m_y2;
+
+        alignas(64) Lane in{};
+        alignas(64) Lane out{};
+
+        for(size_t i = 0; i < numFrames; i++){
+            load(i, in);
+            for(size_t l = 0; l < Lanes; l++){
+                const auto sample = in[l];
+                auto y = a0[l] * sample + a1[l] * x1[l] + a2[l] * x2[l];
+                y +=                      b1[l] * y1[l] + b2[l] * y2[l];
+                antiDenormal(y);
+
+                x2[l] = x1[l];
+                x1[l] = sample;
+                y2[l] = y1[l];
+                y1[l] = y;
+                out[l] = y * c0[l] + sample * d0[l];
+            }
+            store(i, out);
+        }
+
+        m_x1 = x1, m_x2 = x2;
+        m_y1 = y1, m_y2 = y2;
+    }
+
+    template<typename SampleType, size_t Lanes>
+    void BiQuadBank<SampleType, Lanes>::process(const SampleType *input, SampleType *output, size_t numFrames) {
+        run(numFrames
+            , [&](size_t i, Lane& in){ std::copy_n(input + i * Lanes, Lanes, in.begin()); }
+            , [&](size_t i, const Lane& out){ std::copy_n(out.begin(), Lanes, output + i * Lanes); });
+    }
+
+    template<typename SampleType, size_t Lanes>
+    void BiQuadBank<SampleType, Lanes>::process(const std::array<const SampleType *, Lanes> &input,
+                                                const std::array<SampleType *, Lanes> &output, size_t numFrames) {
+        run(numFrames
+            , [&](size_t i, Lane& in){ for(size_t l = 0; l < Lanes; l++) in[l] = input[l][i]; }
+            , [&](size_t i, const Lane& out){ for(size_t l = 0; l < Lanes; l++) output[l][i] = out[l]; });
+    }
+
+    template<typename SampleType, size_t Lanes>
+    void BiQuadBank<SampleType, Lanes>::reset() {
+        m_x1.fill(0);
+        m_x2.fill(0);
+        m_y1.fill(0);
+        m_y2.fill(0);
+    }
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <algorithm>
+#include <type_traits>
+#include "coefficients.h"
+#include "sample_buffer.h"
+
+namespace dsp {
+
+    template<size_t Sections, typename Real = double>
+    struct Cascade {
+        std::array<Coefficients<2, Real>, Sections> sections{};
+
+        template<typename SampleType>
+        SampleBuffer<SampleType> operator()(const SampleBuffer<SampleType> &input);
+
+        template<typename SampleType>
+        SampleType operator()(SampleType iSample);
+
+        /**
+         * filters input into output, resizing it, output may be input
+         */
+        template<typename SampleType>
+        void apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output);
+
+        template<typename SampleType>
+        void process(const SampleType* input, SampleType* output, size_t numSamples);
+
+        template<typename SampleType>
+        void process(std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output);
+
+        /**
+         * input and output may be strided and may be the same samples
+         */
+        template<typename SampleType>
+        void process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output);
+
+        template<typename SampleType>
+        void process(SampleBufferView<SampleType> samples);
+
+        void reset();
+
+        /**
+         * primes every section to the steady state of a constant input, returns the settled output
+         */
+        Real prime(Real input);
+
+        template<typename Other>
+        constexpr Cascade<Sections, Other> cast() const;
+
+        static constexpr size_t poles = 2 * Sections;
+
+        using real_type = Real;
+
+        // number of samples run through every section before moving on to the next block,
+        // small enough for the block to stay in L1 between sections
+        static constexpr size_t BlockSize = 256;
+    };
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    SampleBuffer<SampleType> Cascade<Sections, Real>::operator()(const SampleBuffer<SampleType> &input) {
+        SampleBuffer<SampleType> output(input.size());
+        process(input.data(), output.data(), input.size());
+
+        return output;
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    SampleType Cascade<Sections, Real>::operator()(SampleType iSample) {
+        for(auto& section : sections){
+            iSample = section(iSample);
+        }
+        return iSample;
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    void Cascade<Sections, Real>::apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output) {
+        output.resize(input.size());
+        process(input.data(), output.data(), input.size());
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    void Cascade<Sections, Real>::process(const SampleType *input, SampleType *output, size_t numSamples) {
+        for(size_t offset = 0; offset < numSamples; offset += BlockSize){
+            const auto N = std::min(BlockSize, numSamples - offset);
+            const SampleType* src = input + offset;
+            auto dst = output + offset;
+
+            for(auto& section : sections){
+                section.process(src, dst, N);
+                src = dst;
+            }
+        }
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    void Cascade<Sections, Real>::process(std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output) {
+        assert(output.size() >= input.size());
+        process(input.data(), output.data(), input.size());
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    void Cascade<Sections, Real>::process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            process(input.data(), output.data(), input.size());
+            return;
+        }
+
+        // same blocking as the contiguous path, sections after the first filter the output in place
+        for(size_t offset = 0; offset < input.size(); offset += BlockSize){
+            const auto N = std::min(BlockSize, input.size() - offset);
+            const auto dst = output.subview(offset, N);
+
+            sections[0].template process<SampleType>(input.subview(offset, N), dst);
+            for(size_t i = 1; i < Sections; i++){
+                sections[i].template process<SampleType>(dst);
+            }
+        }
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename SampleType>
+    void Cascade<Sections, Real>::process(SampleBufferView<SampleType> samples) {
+        process<SampleType>(samples, samples);
+    }
+
+    template<size_t Sections, typename Real>
+    void Cascade<Sections, Real>::reset() {
+        for(auto& section : sections){
+            section.reset();
+        }
+    }
+
+    template<size_t Sections, typename Real>
+    Real Cascade<Sections, Real>::prime(Real input) {
+        for(auto& section : sections){
+            input = section.prime(input);
+        }
+        return input;
+    }
+
+    template<size_t Sections, typename Real>
+    template<typename Other>
+    constexpr Cascade<Sections, Other> Cascade<Sections, Real>::cast() const {
+        Cascade<Sections, Other> other{};
+        for(size_t i = 0; i < Sections; i++){
+            other.sections[i] = sections[i].template cast<Other>();
+        }
+        return other;
+    }
+}
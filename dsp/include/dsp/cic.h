@@ -0,0 +1,336 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include "constants.h"
+#include "sample_buffer.h"
+
+namespace dsp {
+
+    /**
+     * Cascaded integrator-comb decimator, reduces the sample rate by an integer rate with Order
+     * integrators at the input rate and Order combs at the output rate, so it costs Order adds per
+     * input sample no matter how large the rate is. Meant for meters, envelopes and trend plots
+     * reading 100x to 1000x less often than the audio rate.
+     *
+     * The response is (sin(PI f R) / (R sin(PI f)))^Order, its nulls sit on every multiple of
+     * the output rate so that is where aliasing is suppressed the most. The optional compensation
+     * filter is a short linear phase FIR at the output rate that flattens the droop of that
+     * response over the pass band.
+     *
+     * Samples are quantized to fixed point and the integrators run on uint64_t, so they may wrap
+     * around freely, the combs undo the wrap as long as the output fits, which holds for inputs
+     * within +-MaxInput. Order * log2(rate) bits of the 64 are used for growth, what is left after
+     * MaxInput's bits is the precision, at least 16 bits.
+     */
+    template<size_t Order, typename SampleType = float>
+    class CicDecimator {
+    public:
+        static_assert(Order > 0, "CIC order should be at least 1");
+
+        static constexpr double MaxInput = 8;
+
+        /**
+         * @param rate decimation factor
+         * @param compensationTaps 0 for no compensation, otherwise an odd number of FIR taps
+         * @param passband edge of the compensated band as a fraction of the output sample rate
+         */
+        explicit CicDecimator(size_t rate, size_t compensationTaps = 0, double passband = 0.2);
+
+        /**
+         * consumes one input sample, returns true and writes output every rate samples
+         */
+        bool process(SampleType input, SampleType& output);
+
+        /**
+         * consumes numSamples inputs, writes the outputs that became ready and returns their count,
+         * at most (numSamples + rate - 1) / rate
+         */
+        size_t process(const SampleType* input, size_t numSamples, SampleType* output);
+
+        /**
+         * input and output may be strided, output needs room for (input.size() + rate - 1) / rate samples
+         */
+        size_t process(SampleBufferView<const SampleType> input, SampleBufferView<SampleType> output);
+
+        [[nodiscard]]
+        size_t rate() const;
+
+        /**
+         * group delay in input samples, including the compensation filter
+         */
+        [[nodiscard]]
+        double delay() const;
+
+        [[nodiscard]]
+        const std::vector<double>& compensation() const;
+
+        void reset();
+
+    private:
+        // shared by the pointer and view overloads, Input and Output are anything indexable
+        template<typename Input, typename Output>
+        size_t processSamples(Input input, size_t numSamples, Output output);
+
+        SampleType comb();
+
+        SampleType compensate(SampleType sample);
+
+    private:
+        size_t m_rate;
+        size_t m_phase{0};
+        double m_inputScale;
+        double m_outputScale;
+
+        std::array<uint64_t, Order> m_integrators{};
+        std::array<uint64_t, Order> m_combs{};
+
+        std::vector<double> m_compensation;
+
+        // newest compensation().size() outputs, mirrored
+        std::vector<double> m_history;
+        size_t m_head{0};
+    };
+
+    /**
+     * magnitude response of a CIC decimator at frequency, a fraction of the output sample rate
+     */
+    double cicResponse(size_t order, size_t rate, double frequency);
+
+    /**
+     * least squares linear phase FIR of numTaps (odd) at the output rate that inverts the CIC
+     * droop up to passband, a fraction of the output sample rate
+     */
+    std::vector<double> cicCompensation(size_t order, size_t rate, size_t numTaps, double passband = 0.2);
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    namespace details {
+
+        // solves A x = b by Gaussian elimination with partial pivoting
+        inline std::vector<double> solve(std::vector<std::vector<double>> A, std::vector<double> b) {
+            const auto N = b.size();
+            for(size_t col = 0; col < N; col++){
+                size_t pivot = col;
+                for(size_t row = col + 1; row < N; row++){
+                    if(std::abs(A[row][col]) > std::abs(A[pivot][col])) pivot = row;
+                }
+                std::swap(A[col], A[pivot]);
+                std::swap(b[col], b[pivot]);
+
+                for(size_t row = col + 1; row < N; row++){
+                    const auto f = A[row][col] / A[col][col];
+                    for(size_t k = col; k < N; k++){
+                        A[row][k] -= f * A[col][k];
+                    }
+                    b[row] -= f * b[col];
+                }
+            }
+
+            std::vector<double> x(N);
+            for(size_t row = N; row > 0; row--){
+                const auto i = row - 1;
+                auto sum = b[i];
+                for(size_t k = i + 1; k < N; k++){
+                    sum -= A[i][k] * x[k];
+                }
+                x[i] = sum / A[i][i];
+            }
+            return x;
+        }
+    }
+
+    inline double cicResponse(size_t order, size_t rate, double frequency) {
+        const auto R = static_cast<double>(rate);
+        const auto num = std::sin(PI * frequency);
+        const auto den = R * std::sin(PI * frequency / R);
+        const auto h = std::abs(den) < 1e-12 ? 1.0 : std::abs(num / den);
+        return std::pow(h, static_cast<double>(order));
+    }
+
+    inline std::vector<double> cicCompensation(size_t order, size_t rate, size_t numTaps, double passband) {
+        assert(numTaps % 2 == 1);
+        assert(passband > 0 && passband < 0.5);
+
+        // H(f) = h0 + 2 sum(h[k] cos(2 PI f k)) fitted to 1 / cicResponse over the pass band only,
+        // the CIC's own roll off keeps the compensated response below unity past it
+        constexpr size_t GridSize = 256;
+        const auto K = numTaps / 2 + 1;
+
+        std::vector<std::vector<double>> A(K, std::vector<double>(K));
+        std::vector<double> b(K);
+        std::vector<double> basis(K);
+
+        for(size_t i = 0; i <= GridSize; i++){
+            const auto f = passband * static_cast<double>(i) / GridSize;
+            const auto target = 1 / cicResponse(order, rate, f);
+
+            basis[0] = 1;
+            for(size_t k = 1; k < K; k++){
+                basis[k] = 2 * std::cos(_2_PI * f * static_cast<double>(k));
+            }
+            for(size_t r = 0; r < K; r++){
+                for(size_t c = 0; c < K; c++){
+                    A[r][c] += basis[r] * basis[c];
+                }
+                b[r] += basis[r] * target;
+            }
+        }
+
+        const auto half = details::solve(std::move(A), std::move(b));
+
+        std::vector<double> kernel(numTaps);
+        const auto center = numTaps / 2;
+        for(size_t k = 0; k < K; k++){
+            kernel[center + k] = kernel[center - k] = half[k];
+        }
+
+        // unity gain at DC, where the CIC itself has unity gain
+        double sum{};
+        for(auto h : kernel) sum += h;
+        for(auto& h : kernel) h /= sum;
+
+        return kernel;
+    }
+
+    template<size_t Order, typename SampleType>
+    CicDecimator<Order, SampleType>::CicDecimator(size_t rate, size_t compensationTaps, double passband)
+    : m_rate{ rate }
+    {
+        assert(rate > 0);
+
+        const auto growth = static_cast<int>(std::ceil(static_cast<double>(Order) * std::log2(static_cast<double>(rate))));
+        const auto fractionBits = 63 - growth - static_cast<int>(std::log2(MaxInput));
+        assert(fractionBits >= 16 && "rate ^ Order too large for 64 bit integrators");
+
+        m_inputScale = std::ldexp(1.0, fractionBits);
+        m_outputScale = 1 / (m_inputScale * std::pow(static_cast<double>(rate), static_cast<double>(Order)));
+
+        if(compensationTaps > 0){
+            m_compensation = cicCompensation(Order, rate, compensationTaps, passband);
+            m_history.resize(2 * compensationTaps);
+        }
+    }
+
+    template<size_t Order, typename SampleType>
+    bool CicDecimator<Order, SampleType>::process(SampleType input, SampleType &output) {
+        const auto x = std::clamp(static_cast<double>(input), -MaxInput, MaxInput);
+        m_integrators[0] += static_cast<uint64_t>(static_cast<int64_t>(x * m_inputScale));
+        for(size_t i = 1; i < Order; i++){
+            m_integrators[i] += m_integrators[i - 1];
+        }
+
+        if(++m_phase < m_rate) return false;
+
+        m_phase = 0;
+        output = compensate(comb());
+        return true;
+    }
+
+    template<size_t Order, typename SampleType>
+    size_t CicDecimator<Order, SampleType>::process(const SampleType *input, size_t numSamples, SampleType *output) {
+        return processSamples(input, numSamples, output);
+    }
+
+    template<size_t Order, typename SampleType>
+    size_t CicDecimator<Order, SampleType>::process(SampleBufferView<const SampleType> input, SampleBufferView<SampleType> output) {
+        assert(output.size() >= (input.size() + m_rate - 1) / m_rate);
+        if(input.contiguous() && output.contiguous()){
+            return processSamples(input.data(), input.size(), output.data());
+        }
+        return processSamples(input, input.size(), output);
+    }
+
+    template<size_t Order, typename SampleType>
+    template<typename Input, typename Output>
+    size_t CicDecimator<Order, SampleType>::processSamples(Input input, size_t numSamples, Output output) {
+        size_t count = 0;
+        for(size_t offset = 0; offset < numSamples;){
+            // integrate up to the next output on local copies so the loop keeps them in registers
+            const auto N = std::min(m_rate - m_phase, numSamples - offset);
+            auto integrators = m_integrators;
+            for(size_t n = 0; n < N; n++){
+                const auto x = std::clamp(static_cast<double>(input[offset + n]), -MaxInput, MaxInput);
+                integrators[0] += static_cast<uint64_t>(static_cast<int64_t>(x * m_inputScale));
+                for(size_t i = 1; i < Order; i++){
+                    integrators[i] += integrators[i - 1];
+                }
+            }
+            m_integrators = integrators;
+
+            offset += N;
+            m_phase += N;
+            if(m_phase == m_rate){
+                m_phase = 0;
+                output[count++] = compensate(comb());
+            }
+        }
+        return count;
+    }
+
+    template<size_t Order, typename SampleType>
+    SampleType CicDecimator<Order, SampleType>::comb() {
+        auto value = m_integrators[Order - 1];
+        for(size_t i = 0; i < Order; i++){
+            const auto previous = m_combs[i];
+            m_combs[i] = value;
+            value -= previous;
+        }
+        return static_cast<SampleType>(static_cast<double>(static_cast<int64_t>(value)) * m_outputScale);
+    }
+
+    template<size_t Order, typename SampleType>
+    SampleType CicDecimator<Order, SampleType>::compensate(SampleType sample) {
+        const auto N = m_compensation.size();
+        if(N == 0) return sample;
+
+        m_head = m_head == 0 ? N - 1 : m_head - 1;
+        m_history[m_head] = m_history[m_head + N] = sample;
+
+        const auto X = m_history.data() + m_head;
+        double sum{};
+        for(size_t i = 0; i < N; i++){
+            sum += m_compensation[i] * X[i];
+        }
+        return static_cast<SampleType>(sum);
+    }
+
+    template<size_t Order, typename SampleType>
+    size_t CicDecimator<Order, SampleType>::rate() const {
+        return m_rate;
+    }
+
+    template<size_t Order, typename SampleType>
+    double CicDecimator<Order, SampleType>::delay() const {
+        const auto R = static_cast<double>(m_rate);
+        const auto cic = static_cast<double>(Order) * (R - 1) / 2;
+        const auto fir = m_compensation.empty() ? 0.0 : static_cast<double>(m_compensation.size() - 1) / 2 * R;
+        return cic + fir;
+    }
+
+    template<size_t Order, typename SampleType>
+    const std::vector<double>& CicDecimator<Order, SampleType>::compensation() const {
+        return m_compensation;
+    }
+
+    template<size_t Order, typename SampleType>
+    void CicDecimator<Order, SampleType>::reset() {
+        m_integrators.fill(0);
+        m_combs.fill(0);
+        std::fill(m_history.begin(), m_history.end(), 0.0);
+        m_phase = 0;
+        m_head = 0;
+    }
+}
@@ -1,18 +1,39 @@
 #pragma once
 
 #include <array>
+#include <span>
+#include <type_traits>
 #include "sample_buffer.h"
+#include "denormal.h"
 
 namespace dsp {
-    template<size_t Poles>
+
+    /**
+     * Direct form recursive filter, Real is the type of the coefficients and of the filter state.
+     * Designs are computed in double, cast<float>() gives a copy that filters float samples
+     * without converting every sample to and from double.
+     *
+     * Float direct form above two poles loses precision quickly as the cutoff drops, against double
+     * at a cutoff of 0.05 a 4 pole filter keeps about 94 dB SNR and a 6 pole one 45 dB, at 0.02 the
+     * 6 pole one diverges. For more than two poles in float prefer a Cascade of biquads, e.g.
+     * recursive::lowPassCascade<Poles, float> or highPassCascade<Poles, float>.
+     */
+    template<size_t Poles, typename Real = double>
     struct Coefficients {
-        std::array<double, Poles + 1u> a{};
-        std::array<double, Poles + 1u> b{};
-        std::array<double, Poles + 1u> x{};
-        std::array<double, Poles + 1u> y{};
+        static_assert(std::is_floating_point_v<Real>, "Real should be floating point type");
+
+        std::array<Real, Poles + 1u> a{};
+        std::array<Real, Poles + 1u> b{};
+
+        // input and output history, stored twice back to back so that the
+        // newest Poles + 1 samples are always contiguous starting at head
+        std::array<Real, 2 * (Poles + 1u)> x{};
+        std::array<Real, 2 * (Poles + 1u)> y{};
 
-        double c0{1};
-        double d0{0};
+        Real c0{1};
+        Real d0{0};
+
+        size_t head{0};
 
         template<typename SampleType>
         SampleBuffer<SampleType> operator()(const SampleBuffer<SampleType> &input);
@@ -23,52 +44,96 @@ namespace dsp {
         template<typename SampleType, size_t Capacity>
         void operator()(const SampleBuffer<SampleType> &input, CircularBuffer<SampleType, Capacity> &output);
 
+        /**
+         * filters input into output, resizing it, output may be input
+         */
+        template<typename SampleType>
+        void apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output);
+
+        template<typename SampleType>
+        void process(const SampleType* input, SampleType* output, size_t numSamples);
+
+        template<typename SampleType>
+        void process(std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output);
+
+        /**
+         * input and output may be strided, e.g. one channel of interleaved frames, and may be the same samples
+         */
+        template<typename SampleType>
+        void process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output);
+
+        template<typename SampleType>
+        void process(SampleBufferView<SampleType> samples);
+
+        void reset();
+
+        /**
+         * sets the history to the steady state of a constant input, so filtering a signal
+         * starting at input begins without a transient. Returns the settled output
+         */
+        Real prime(Real input);
+
+        /**
+         * copy of the design with coefficients of type Other and cleared state
+         */
+        template<typename Other>
+        constexpr Coefficients<Poles, Other> cast() const;
+
         static constexpr size_t poles = Poles;
 
+        using real_type = Real;
+
+    private:
+        // shared by the pointer and view overloads, Input and Output are anything indexable
+        template<typename Input, typename Output>
+        void processSamples(Input input, Output output, size_t numSamples);
+
 //        template<typename SampleType, size_t Capacity>
 //        auto stream();
     };
 
-    template<>
-    struct Coefficients<2> {
+    template<typename Real>
+    struct Coefficients<2, Real> {
+        static_assert(std::is_floating_point_v<Real>, "Real should be floating point type");
+
         union {
-            std::array<double, 3u> a{};
+            std::array<Real, 3u> a{};
             struct {
-                double a0;
-                double a1;
-                double a2;
+                Real a0;
+                Real a1;
+                Real a2;
             };
         };
 
         union {
-            std::array<double, 3u> b{};
+            std::array<Real, 3u> b{};
             struct {
-                double b0;
-                double b1;
-                double b2;
+                Real b0;
+                Real b1;
+                Real b2;
             };
         };
 
         union {
-            std::array<double, 3u> x{};
+            std::array<Real, 3u> x{};
             struct {
-                double x0;
-                double x1;
-                double x2;
+                Real x0;
+                Real x1;
+                Real x2;
             };
         };
 
         union {
-            std::array<double, 3u> y{};
+            std::array<Real, 3u> y{};
             struct {
-                double y0;
-                double y1;
-                double y2;
+                Real y0;
+                Real y1;
+                Real y2;
             };
         };
 
-        double c0{1};
-        double d0{0};
+        Real c0{1};
+        Real d0{0};
 
         template<typename SampleType>
         SampleBuffer<SampleType> operator()(const SampleBuffer<SampleType> &input);
@@ -78,6 +143,40 @@ namespace dsp {
 
         template<typename SampleType, size_t Capacity>
         void operator()(const SampleBuffer<SampleType> &input, CircularBuffer<SampleType, Capacity> &output);
+
+        template<typename SampleType>
+        void apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output);
+
+        template<typename SampleType>
+        void process(const SampleType* input, SampleType* output, size_t numSamples);
+
+        template<typename SampleType>
+        void process(std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output);
+
+        /**
+         * input and output may be strided, e.g. one channel of interleaved frames, and may be the same samples
+         */
+        template<typename SampleType>
+        void process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output);
+
+        template<typename SampleType>
+        void process(SampleBufferView<SampleType> samples);
+
+        void reset();
+
+        Real prime(Real input);
+
+        template<typename Other>
+        constexpr Coefficients<2, Other> cast() const;
+
+        static constexpr size_t poles = 2;
+
+        using real_type = Real;
+
+    private:
+        // shared by the pointer and view overloads, Input and Output are anything indexable
+        template<typename Input, typename Output>
+        void processSamples(Input input, Output output, size_t numSamples);
     };
 
     using BiQuad = Coefficients<2>;
@@ -86,116 +185,292 @@ namespace dsp {
     using SixPoleCoefficients = Coefficients<6>;
 
     template<size_t Poles>
+    using FloatCoefficients = Coefficients<Poles, float>;
+
+    template<size_t Poles>
+    using DoubleCoefficients = Coefficients<Poles, double>;
+
+    using FloatBiQuad = Coefficients<2, float>;
+    using DoubleBiQuad = Coefficients<2, double>;
+
+    template<size_t Poles, typename Real>
     template<typename SampleType>
-    SampleBuffer<SampleType> Coefficients<Poles>::operator()(const SampleBuffer<SampleType> &input) {
-        auto &A = a;
-        auto &B = b;
-        assert(B[0] == 0);
-        assert(!A.empty());
-        assert(!B.empty());
+    SampleBuffer<SampleType> Coefficients<Poles, Real>::operator()(const SampleBuffer<SampleType> &input) {
+        assert(b[0] == 0);
+
+        SampleBuffer<SampleType> output(input.size());
+        process(input.data(), output.data(), input.size());
+
+        return output;
+    }
+
+    template<size_t Poles, typename Real>
+    template<typename SampleType>
+    SampleType Coefficients<Poles, Real>::operator()(SampleType iSample) {
+        constexpr auto N = Poles + 1u;
+
+        const auto sample = static_cast<Real>(iSample);
+        head = head == 0 ? N - 1 : head - 1;
+        x[head] = x[head + N] = sample;
+
+        const auto X = x.data() + head;
+        const auto Y = y.data() + head;
+
+        Real oSample{};
+        for(size_t i = 0; i < N; i++){
+            oSample += a[i] * X[i];
+        }
+        for(size_t i = 1; i < N; i++){
+            oSample += b[i] * Y[i];
+        }
+        antiDenormal(oSample);
+        y[head] = y[head + N] = oSample;
+
+        return static_cast<SampleType>(oSample * c0 + sample * d0);
+    }
+
+    template<size_t Poles, typename Real>
+    template<typename SampleType, size_t Capacity>
+    void Coefficients<Poles, Real>::operator()(const SampleBuffer<SampleType> &input,
+                                               CircularBuffer<SampleType, Capacity> &output) {
+        assert(b[0] == 0);
 
         const auto N = input.size();
-        SampleBuffer<SampleType> output(N);
         for(int i = 0; i < N; i++){
             output[i] = this->operator()(input[i]);
         }
+    }
 
-        return output;
+    template<size_t Poles, typename Real>
+    template<typename SampleType>
+    void Coefficients<Poles, Real>::apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output) {
+        output.resize(input.size());
+        process(input.data(), output.data(), input.size());
     }
 
-    template<size_t Poles>
+    template<size_t Poles, typename Real>
     template<typename SampleType>
-    SampleType Coefficients<Poles>::operator()(SampleType iSample) {
-        SampleType oSample{};
+    void Coefficients<Poles, Real>::process(const SampleType *input, SampleType *output, size_t numSamples) {
+        processSamples(input, output, numSamples);
+    }
 
-        auto N = a.size();
-        x[0] = iSample;
-        for(int i = 0; i < N; i++){
-            oSample += a[i] * x[i];
-        }
-        for(int i = 1; i < N; i++){
-            oSample += b[i] * y[i];
+    template<size_t Poles, typename Real>
+    template<typename SampleType>
+    void Coefficients<Poles, Real>::process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            processSamples(input.data(), output.data(), input.size());
+        }else {
+            processSamples(input, output, input.size());
         }
+    }
 
-        for(int i = (N - 1); i > 0; --i){
-            x[i] = x[i - 1];
-        }
-        for(int i = (N - 1); i > 0; --i){
-            y[i] = y[i - 1];
+    template<size_t Poles, typename Real>
+    template<typename SampleType>
+    void Coefficients<Poles, Real>::process(SampleBufferView<SampleType> samples) {
+        process<SampleType>(samples, samples);
+    }
+
+    template<size_t Poles, typename Real>
+    template<typename Input, typename Output>
+    void Coefficients<Poles, Real>::processSamples(Input input, Output output, size_t numSamples) {
+        using OutputType = std::remove_cvref_t<decltype(output[0])>;
+        constexpr auto N = Poles + 1u;
+
+        // work on local copies so writes to output can't alias the filter state
+        const auto A = a;
+        const auto B = b;
+        auto X = x;
+        auto Y = y;
+        auto h = head;
+
+        for(size_t i = 0; i < numSamples; i++){
+            const auto iSample = static_cast<Real>(input[i]);
+            h = h == 0 ? N - 1 : h - 1;
+            X[h] = X[h + N] = iSample;
+
+            Real oSample{};
+            for(size_t j = 0; j < N; j++){
+                oSample += A[j] * X[h + j];
+            }
+            for(size_t j = 1; j < N; j++){
+                oSample += B[j] * Y[h + j];
+            }
+            antiDenormal(oSample);
+            Y[h] = Y[h + N] = oSample;
+
+            output[i] = static_cast<OutputType>(oSample * c0 + iSample * d0);
         }
-        x[0] = 0;
-        y[1] = oSample;
 
-        return oSample * c0 + iSample * d0;
+        x = X;
+        y = Y;
+        head = h;
     }
 
-    template<size_t Poles>
-    template<typename SampleType, size_t Capacity>
-    void Coefficients<Poles>::operator()(const SampleBuffer<SampleType> &input,
-                                         CircularBuffer<SampleType, Capacity> &output) {
-        auto &A = a;
-        auto &B = b;
-        assert(B[0] == 0);
-        assert(!A.empty());
-        assert(!B.empty());
+    template<size_t Poles, typename Real>
+    template<typename SampleType>
+    void Coefficients<Poles, Real>::process(std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output) {
+        assert(output.size() >= input.size());
+        process(input.data(), output.data(), input.size());
+    }
 
-        static std::array<double, Poles> prevInput{};
+    template<size_t Poles, typename Real>
+    void Coefficients<Poles, Real>::reset() {
+        x.fill(0);
+        y.fill(0);
+        head = 0;
+    }
 
-        const auto N = input.size();
-        const auto aN = A.size();
-        const auto bN = B.size();
-        SampleBuffer<SampleType> X(input.size() + Poles);
-        auto dest = X.begin();
-        std::copy(prevInput.begin(), prevInput.end(), dest);
-        std::advance(dest, Poles);
-        std::copy(input.cbegin(), input.cend(), dest);
-
-        auto &Y = output;
-
-        for (auto i = 0; i < N; i++) {
-            Y[i] = 0;
-            for (auto j = 0; j < aN; j++) {
-                Y[i] += A[j] * X[i + Poles - j];
-            }
+    template<size_t Poles, typename Real>
+    Real Coefficients<Poles, Real>::prime(Real input) {
+        Real gain{};
+        for(size_t i = 0; i < Poles + 1u; i++){
+            gain += a[i];
+        }
+        Real feedback{1};
+        for(size_t i = 1; i < Poles + 1u; i++){
+            feedback -= b[i];
+        }
+        const auto output = input * gain / feedback;
 
-            for (auto j = 1; j < bN; j++) {
-                Y[i] += B[j] * Y[i - j];
-            }
+        x.fill(input);
+        y.fill(output);
+        head = 0;
 
-            Y[i] = Y[i] * c0 + X[i] * d0;
+        return output * c0 + input * d0;
+    }
+
+    template<size_t Poles, typename Real>
+    template<typename Other>
+    constexpr Coefficients<Poles, Other> Coefficients<Poles, Real>::cast() const {
+        Coefficients<Poles, Other> other{};
+        for(size_t i = 0; i < Poles + 1u; i++){
+            other.a[i] = static_cast<Other>(a[i]);
+            other.b[i] = static_cast<Other>(b[i]);
         }
-        auto start = input.cend();
-        std::advance(start, -Poles);
-        std::copy(start, input.cend(), prevInput.begin());
+        other.c0 = static_cast<Other>(c0);
+        other.d0 = static_cast<Other>(d0);
+
+        return other;
     }
 
+    template<typename Real>
     template<typename SampleType>
-    SampleType Coefficients<2>::operator()(SampleType sample){
+    SampleType Coefficients<2, Real>::operator()(SampleType iSample){
+        const auto sample = static_cast<Real>(iSample);
         auto y = a0 * sample + a1 * x1 + a2 * x2;
         y +=                  b1 * y1 + b2 * y2;
+        antiDenormal(y);
 
         x2 = x1;
         x1 = sample;
         y2 = y1;
         y1 = y;
-        return (y * c0) + (sample * d0);
+        return static_cast<SampleType>((y * c0) + (sample * d0));
     }
 
+    template<typename Real>
     template<typename SampleType>
-    SampleBuffer<SampleType> Coefficients<2>::operator()(const SampleBuffer<SampleType> &input) {
-        SampleBuffer<SampleType> output{};
+    void Coefficients<2, Real>::process(const SampleType *input, SampleType *output, size_t numSamples) {
+        processSamples(input, output, numSamples);
+    }
 
-        const auto N = input.size();
-        for(int i = 0; i < N; i++){
-            auto iSample = input[i];
-            auto oSample = this->operator()(iSample);
-            output.add(oSample);
+    template<typename Real>
+    template<typename SampleType>
+    void Coefficients<2, Real>::process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            processSamples(input.data(), output.data(), input.size());
+        }else {
+            processSamples(input, output, input.size());
+        }
+    }
+
+    template<typename Real>
+    template<typename SampleType>
+    void Coefficients<2, Real>::process(SampleBufferView<SampleType> samples) {
+        process<SampleType>(samples, samples);
+    }
+
+    template<typename Real>
+    template<typename Input, typename Output>
+    void Coefficients<2, Real>::processSamples(Input input, Output output, size_t numSamples) {
+        using OutputType = std::remove_cvref_t<decltype(output[0])>;
+        auto X1 = x1, X2 = x2;
+        auto Y1 = y1, Y2 = y2;
+
+        for(size_t i = 0; i < numSamples; i++){
+            const auto sample = static_cast<Real>(input[i]);
+            auto y = a0 * sample + a1 * X1 + a2 * X2;
+            y +=                   b1 * Y1 + b2 * Y2;
+            antiDenormal(y);
+
+            X2 = X1;
+            X1 = sample;
+            Y2 = Y1;
+            Y1 = y;
+            output[i] = static_cast<OutputType>((y * c0) + (sample * d0));
         }
+
+        x1 = X1, x2 = X2;
+        y1 = Y1, y2 = Y2;
+    }
+
+    template<typename Real>
+    template<typename SampleType>
+    void Coefficients<2, Real>::process(std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output) {
+        assert(output.size() >= input.size());
+        process(input.data(), output.data(), input.size());
+    }
+
+    template<typename Real>
+    void Coefficients<2, Real>::reset() {
+        x.fill(0);
+        y.fill(0);
+    }
+
+    template<typename Real>
+    Real Coefficients<2, Real>::prime(Real input) {
+        const auto output = input * (a0 + a1 + a2) / (1 - b1 - b2);
+        x.fill(input);
+        y.fill(output);
+
+        return output * c0 + input * d0;
+    }
+
+    template<typename Real>
+    template<typename Other>
+    constexpr Coefficients<2, Other> Coefficients<2, Real>::cast() const {
+        Coefficients<2, Other> other{};
+        for(size_t i = 0; i < 3u; i++){
+            other.a[i] = static_cast<Other>(a[i]);
+            other.b[i] = static_cast<Other>(b[i]);
+        }
+        other.c0 = static_cast<Other>(c0);
+        other.d0 = static_cast<Other>(d0);
+
+        return other;
+    }
+
+    template<typename Real>
+    template<typename SampleType>
+    SampleBuffer<SampleType> Coefficients<2, Real>::operator()(const SampleBuffer<SampleType> &input) {
+        SampleBuffer<SampleType> output(input.size());
+        process(input.data(), output.data(), input.size());
+
         return output;
     }
 
+    template<typename Real>
+    template<typename SampleType>
+    void Coefficients<2, Real>::apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output) {
+        output.resize(input.size());
+        process(input.data(), output.data(), input.size());
+    }
+
+    template<typename Real>
     template<typename SampleType, size_t Capacity>
-    void Coefficients<2>::operator()(const SampleBuffer<SampleType> &input, CircularBuffer<SampleType, Capacity> &output) {
+    void Coefficients<2, Real>::operator()(const SampleBuffer<SampleType> &input, CircularBuffer<SampleType, Capacity> &output) {
 
         const auto N = input.size();
         for(int i = 0; i < N; i++){
@@ -204,4 +479,12 @@ namespace dsp {
             output[i] = oSample;
         }
     }
-}
\ No newline at end of file
+
+    // instantiated once in dsp/src/coefficients.cpp
+    extern template struct Coefficients<2, float>;
+    extern template struct Coefficients<2, double>;
+    extern template struct Coefficients<4, float>;
+    extern template struct Coefficients<4, double>;
+    extern template struct Coefficients<6, float>;
+    extern template struct Coefficients<6, double>;
+}
@@ -1,30 +1,50 @@
 #pragma once
 
+#include <stdexcept>
+#include <algorithm>
 #include "dsp.h"
 #include "sample_buffer.h"
 
 namespace dsp {
 
+    /**
+     * output[j] = sum(signal[j - i] * kernel[i]) for j >= kernel.size() - 1, earlier outputs are
+     * zero. output is resized and may be signal itself
+     */
     template<typename SampleType, Domain domain>
-    SampleBuffer<SampleType> convolve(const Signal<SampleType>& signal, const Kernel<SampleType>& kernel){
+    void convolve(const Signal<SampleType>& signal, const Kernel<SampleType>& kernel, SampleBuffer<SampleType>& output){
         if constexpr (domain == Domain::Frequency){
             throw std::runtime_error("Not yet implemented!");
         }else{
-            SampleBuffer<SampleType> output(signal.size());
             const auto N = signal.size();
             const auto M = kernel.size();
-            const auto& X = signal;
-            const auto& H = kernel;
-            auto& Y = output;
+            output.resize(N);
 
+            const auto X = signal.data();
+            const auto H = kernel.data();
+            auto Y = output.data();
+            if(M == 0 || N < M){
+                std::fill(Y, Y + N, SampleType{});
+                return;
+            }
 
-            for(auto j = M; j < N; j++){
-                for(auto i = 0; i <= M; i++){
-                    Y[j] = Y[j] + X[j - i] * H[i];
+            // newest first so convolving in place never reads an overwritten sample
+            for(auto j = N; j-- > M - 1;){
+                SampleType sum{};
+                for(size_t i = 0; i < M; i++){
+                    sum += X[j - i] * H[i];
                 }
+                Y[j] = sum;
             }
-
-            return output;
+            std::fill(Y, Y + (M - 1), SampleType{});
         }
     }
+
+    template<typename SampleType, Domain domain>
+    SampleBuffer<SampleType> convolve(const Signal<SampleType>& signal, const Kernel<SampleType>& kernel){
+        SampleBuffer<SampleType> output(signal.size());
+        convolve<SampleType, domain>(signal, kernel, output);
+
+        return output;
+    }
 }
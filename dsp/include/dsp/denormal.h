@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define DSP_HAS_MXCSR 1
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+#define DSP_HAS_FPCR 1
+#endif
+
+namespace dsp {
+
+    /**
+     * Flushes subnormal floats to zero on the calling thread for as long as it lives and restores
+     * the previous floating point mode when destroyed. Decaying IIR tails otherwise end up in the
+     * subnormal range, which costs 10-100x per operation on x86.
+     *
+     * Sets FTZ and DAZ in MXCSR on x86, FZ in FPCR on aarch64, and does nothing elsewhere.
+     */
+    class ScopedNoDenormals {
+    public:
+        ScopedNoDenormals();
+
+        ~ScopedNoDenormals();
+
+        ScopedNoDenormals(const ScopedNoDenormals&) = delete;
+
+        ScopedNoDenormals& operator=(const ScopedNoDenormals&) = delete;
+
+    private:
+        uint64_t m_previous{0};
+    };
+
+    /**
+     * For code that can't change the CPU mode, the DSP_ANTI_DENORMAL CMake option makes the
+     * recursive filters add AntiDenormalOffset to their feedback state every sample, which holds
+     * decaying tails above the subnormal range at the cost of an inaudible DC offset.
+     *
+     * The option defines DSP_ANTI_DENORMAL publicly on the dsp target, so everything linking dsp
+     * sees the same setting. Don't define it in individual files, translation units that disagree
+     * would end up with two different definitions of the same inline filter code.
+     */
+#ifdef DSP_ANTI_DENORMAL
+    inline constexpr bool AntiDenormal = true;
+#else
+    inline constexpr bool AntiDenormal = false;
+#endif
+
+    inline constexpr double AntiDenormalOffset = 1e-20;
+
+    template<typename Real>
+    constexpr void antiDenormal(Real& state) {
+        if constexpr (AntiDenormal){
+            state += static_cast<Real>(AntiDenormalOffset);
+        }
+    }
+
+#if defined(DSP_HAS_MXCSR)
+    inline ScopedNoDenormals::ScopedNoDenormals()
+    : m_previous{ _mm_getcsr() }
+    {
+        constexpr uint32_t FTZ = 0x8000;
+        constexpr uint32_t DAZ = 0x0040;
+        _mm_setcsr(static_cast<uint32_t>(m_previous) | FTZ | DAZ);
+    }
+
+    inline ScopedNoDenormals::~ScopedNoDenormals() {
+        _mm_setcsr(static_cast<uint32_t>(m_previous));
+    }
+#elif defined(DSP_HAS_FPCR)
+    inline ScopedNoDenormals::ScopedNoDenormals() {
+        constexpr uint64_t FZ = 1ull << 24;
+        asm volatile("mrs %0, fpcr" : "=r"(m_previous));
+        asm volatile("msr fpcr, %0" : : "r"(m_previous | FZ));
+    }
+
+    inline ScopedNoDenormals::~ScopedNoDenormals() {
+        asm volatile("msr fpcr, %0" : : "r"(m_previous));
+    }
+#else
+    inline ScopedNoDenormals::ScopedNoDenormals() = default;
+
+    inline ScopedNoDenormals::~ScopedNoDenormals() = default;
+#endif
+}
@@ -8,6 +8,10 @@
 #include <deque>
 #include <ostream>
 #include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include "util.h"
 
 namespace dsp {
 
@@ -17,6 +21,8 @@ namespace dsp {
 
     using Window = std::function<double(size_t, size_t)>;
 
+    enum class WindowType : int { Identity = 0, BlackMan, Hamming, Hann, Kaiser, FlatTop };
+
     enum class InversionType : int { SpectralInversion, SpectralReversal, None};
 
 
@@ -35,9 +41,46 @@ namespace dsp {
             const auto i_over_M = static_cast<double >(i)/static_cast<double >(M);
             return 0.54 - 0.46 * std::cos(2.0 * PI * i_over_M);
         }
+
+        static auto hann(size_t i, size_t M){
+            const auto i_over_M = static_cast<double >(i)/static_cast<double >(M);
+            return 0.5 - 0.5 * std::cos(2.0 * PI * i_over_M);
+        }
+
+        // beta trades main lobe width for side lobe level, 8.6 gives roughly -90dB side lobes
+        static auto kaiser(size_t i, size_t M, double beta = 8.6){
+            const auto r = 2.0 * static_cast<double >(i)/static_cast<double >(M) - 1.0;
+            return besselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+        }
+
+        static auto flatTop(size_t i, size_t M){
+            const auto w = 2.0 * PI * static_cast<double >(i)/static_cast<double >(M);
+            return 0.21557895 - 0.41663158 * std::cos(w) + 0.277263158 * std::cos(2 * w)
+                   - 0.083578947 * std::cos(3 * w) + 0.006947368 * std::cos(4 * w);
+        }
+
+        // zeroth order modified Bessel function of the first kind
+        static double besselI0(double x){
+            const auto q = x * x * 0.25;
+            double term = 1;
+            double sum = 1;
+            for(int k = 1; k < 64 && term > sum * 1e-17; k++){
+                term *= q / (static_cast<double>(k) * k);
+                sum += term;
+            }
+            return sum;
+        }
     };
 
-    void normalize(std::vector<double> &kernel) {
+    using WindowTable = std::shared_ptr<const std::vector<double>>;
+
+    /**
+     * Samples 0..M of the window, computed once per (type, M, parameter) and shared from a cache,
+     * parameter is the Kaiser beta and ignored by the other windows
+     */
+    WindowTable windowTable(WindowType type, size_t M, double parameter = 8.6);
+
+    inline void normalize(std::vector<double> &kernel) {
         const auto sum = std::accumulate(kernel.begin(), kernel.end(), 0.0);
         for(auto& y : kernel){
             y /= sum;
@@ -45,7 +88,7 @@ namespace dsp {
     }
 
     template<InversionType inversionType = InversionType::None>
-    std::vector<double> sinc(double cf, int length, const Window& window = Windows::blackMan) {
+    std::vector<double> sinc(double cf, int length, const Window& window) {
         length = (length | 1);   // length must be odd
         const auto M = length - 1;
         std::vector<double> output;
@@ -77,8 +120,107 @@ namespace dsp {
 
         return output;
     }
+
+    /**
+     * Windowed sinc kernel using a cached window table, no per tap calls through std::function
+     */
+    template<InversionType inversionType = InversionType::None>
+    std::vector<double> sinc(double cf, int length, WindowType window = WindowType::BlackMan);
+
+    using SharedKernel = std::shared_ptr<const std::vector<double>>;
+
+    /**
+     * sinc kernel designed once per (cf, length, window, inversion) and shared from a cache,
+     * rebuilding a filter with parameters it has seen before costs a lookup
+     */
+    template<InversionType inversionType = InversionType::None>
+    SharedKernel sincKernel(double cf, int length, WindowType window = WindowType::BlackMan);
+
+    namespace details {
+
+        inline auto& windowCache() {
+            static LruCache<std::tuple<WindowType, size_t, double>, WindowTable
+                            , TupleHash<WindowType, size_t, double>> cache{ 256 };
+            return cache;
+        }
+
+        inline auto& kernelCache() {
+            static LruCache<std::tuple<double, int, WindowType, InversionType>, SharedKernel
+                            , TupleHash<double, int, WindowType, InversionType>> cache{ 256 };
+            return cache;
+        }
+
+        inline WindowTable computeWindow(WindowType type, size_t M, double parameter) {
+            auto table = std::make_shared<std::vector<double>>(M + 1);
+            auto& w = *table;
+            for(size_t i = 0; i <= M; i++){
+                switch(type){
+                    case WindowType::Identity: w[i] = Windows::identity(i, M); break;
+                    case WindowType::BlackMan: w[i] = Windows::blackMan(i, M); break;
+                    case WindowType::Hamming: w[i] = Windows::hamming(i, M); break;
+                    case WindowType::Hann: w[i] = Windows::hann(i, M); break;
+                    case WindowType::Kaiser: w[i] = Windows::kaiser(i, M, parameter); break;
+                    case WindowType::FlatTop: w[i] = Windows::flatTop(i, M); break;
+                }
+            }
+            return table;
+        }
+    }
+
+    inline WindowTable windowTable(WindowType type, size_t M, double parameter) {
+        if(type != WindowType::Kaiser){
+            parameter = 0;
+        }
+        const auto key = std::make_tuple(type, M, parameter);
+        return details::windowCache().getOrCompute(key, [&]{ return details::computeWindow(type, M, parameter); });
+    }
+
+    template<InversionType inversionType>
+    std::vector<double> sinc(double cf, int length, WindowType window) {
+        length = (length | 1);   // length must be odd
+        const auto M = length - 1;
+        const auto table = windowTable(window, M);
+        const auto& W = *table;
+
+        std::vector<double> output(length);
+        const auto w = 2 * PI * cf;
+        double sum{};
+        for(auto i = 0; i <= M; i++){
+            const double IM2 = double(i)  - double(M)/2;
+            const auto y = (IM2 == 0 ? w : std::sin(w * IM2)/IM2) * W[i];
+            output[i] = y;
+            sum += y;
+        }
+
+        const auto scale = 1 / sum;
+        for(auto& y : output){
+            y *= scale;
+        }
+
+        if constexpr (inversionType == InversionType::SpectralInversion){
+            for(auto& y : output){
+                y = -y;
+            }
+            output[length/2] += 1;
+        }
+        if constexpr (inversionType == InversionType::SpectralReversal){
+            for(int i = 1; i < length; i += 2){
+                output[i] = -output[i];
+            }
+        }
+
+        return output;
+    }
+
+    template<InversionType inversionType>
+    SharedKernel sincKernel(double cf, int length, WindowType window) {
+        const auto key = std::make_tuple(cf, length, window, inversionType);
+        return details::kernelCache().getOrCompute(key, [&]{
+            return std::make_shared<const std::vector<double>>(sinc<inversionType>(cf, length, window));
+        });
+    }
 }
 
-std::ostream& operator<<(std::ostream& out, const dsp::FilterType& filterType){
+inline std::ostream& operator<<(std::ostream& out, const dsp::FilterType& filterType){
     return out << static_cast<int>(filterType);
 }
\ No newline at end of file
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include "allocator.h"
+
+namespace dsp {
+
+    template<typename Payload>
+    struct TimedEvent {
+        // sample clock time the event takes effect
+        uint64_t time{0};
+        Payload payload{};
+    };
+
+    /**
+     * Bounded lock free queue of timestamped events from any number of producer threads to one
+     * consumer, e.g. MIDI input, UI automation and a second controller all feeding one audio thread.
+     *
+     * Producers claim a slot with a compare and swap on the enqueue index and publish it through
+     * the slot's sequence number, so push never blocks and fails only when the queue is full.
+     * The consumer moves published events onto a heap ordered by time (then by arrival), and
+     * drain(until) hands out every event due before until in that order, later events wait for a
+     * later drain. Producers may stamp events in the past, they are simply due on the next drain.
+     *
+     * drain, wait and pending may only be called by the consumer.
+     */
+    template<typename Payload, size_t Capacity>
+    class EventQueue {
+    public:
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity should be a power of two");
+
+        using Event = TimedEvent<Payload>;
+
+        EventQueue();
+
+        EventQueue(const EventQueue&) = delete;
+
+        EventQueue& operator=(const EventQueue&) = delete;
+
+        /**
+         * any thread, false if the queue is full, the event is then dropped
+         */
+        bool push(uint64_t time, Payload payload);
+
+        /**
+         * calls handler(const Event&) for every event with time < until in time order, returns
+         * how many were handled
+         */
+        template<typename Handler>
+        size_t drain(uint64_t until, Handler&& handler);
+
+        /**
+         * blocks until an event is pushed or wake() is called, returns right away if events are
+         * already waiting
+         */
+        void wait();
+
+        /**
+         * any thread, releases a consumer blocked in wait(), e.g. to shut it down
+         */
+        void wake();
+
+        /**
+         * events taken off the queue that are not yet due
+         */
+        [[nodiscard]]
+        size_t pending() const;
+
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        bool take(Event& event);
+
+        [[nodiscard]]
+        bool published() const;
+
+    private:
+        static constexpr size_t Mask = Capacity - 1;
+
+        struct Slot {
+            std::atomic<size_t> sequence{0};
+            Event event{};
+        };
+
+        struct Pending {
+            Event event{};
+            uint64_t order{0};
+        };
+
+        // shared by the producers
+        alignas(CacheLineSize) std::atomic<size_t> m_enqueueIndex{0};
+        alignas(CacheLineSize) std::atomic<uint32_t> m_signal{0};
+
+        // consumer only
+        alignas(CacheLineSize) size_t m_dequeueIndex{0};
+        uint64_t m_arrivals{0};
+        size_t m_numPending{0};
+        std::array<Pending, Capacity> m_pending{};
+
+        std::array<Slot, Capacity> m_slots{};
+    };
+
+    template<typename Payload, size_t Capacity>
+    EventQueue<Payload, Capacity>::EventQueue() {
+        // a slot is free for the producer claiming index i while its sequence is i, and holds a
+        // published event for the consumer while it is i + 1
+        for(size_t i = 0; i < Capacity; i++){
+            m_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    template<typename Payload, size_t Capacity>
+    bool EventQueue<Payload, Capacity>::push(uint64_t time, Payload payload) {
+        auto index = m_enqueueIndex.load(std::memory_order_relaxed);
+        Slot* slot;
+        while(true){
+            slot = &m_slots[index & Mask];
+            const auto sequence = slot->sequence.load(std::memory_order_acquire);
+            const auto lag = static_cast<std::ptrdiff_t>(sequence - index);
+            if(lag == 0){
+                if(m_enqueueIndex.compare_exchange_weak(index, index + 1, std::memory_order_relaxed)) break;
+            }else if(lag < 0){
+                // the slot still holds the event from one lap ago
+                return false;
+            }else {
+                index = m_enqueueIndex.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->event = Event{ time, std::move(payload) };
+        slot->sequence.store(index + 1, std::memory_order_release);
+
+        m_signal.fetch_add(1, std::memory_order_release);
+        m_signal.notify_one();
+        return true;
+    }
+
+    template<typename Payload, size_t Capacity>
+    bool EventQueue<Payload, Capacity>::published() const {
+        const auto& slot = m_slots[m_dequeueIndex & Mask];
+        return slot.sequence.load(std::memory_order_acquire) == m_dequeueIndex + 1;
+    }
+
+    template<typename Payload, size_t Capacity>
+    bool EventQueue<Payload, Capacity>::take(Event &event) {
+        if(!published()) return false;
+
+        auto& slot = m_slots[m_dequeueIndex & Mask];
+        event = std::move(slot.event);
+        slot.sequence.store(m_dequeueIndex + Capacity, std::memory_order_release);
+        m_dequeueIndex++;
+        return true;
+    }
+
+    template<typename Payload, size_t Capacity>
+    template<typename Handler>
+    size_t EventQueue<Payload, Capacity>::drain(uint64_t until, Handler&& handler) {
+        // top of the heap is the earliest event, arrival order breaks ties
+        const auto later = [](const Pending& a, const Pending& b){
+            return a.event.time != b.event.time ? a.event.time > b.event.time : a.order > b.order;
+        };
+
+        const auto first = m_pending.begin();
+        while(m_numPending < Capacity && take(m_pending[m_numPending].event)){
+            m_pending[m_numPending].order = m_arrivals++;
+            std::push_heap(first, first + static_cast<std::ptrdiff_t>(++m_numPending), later);
+        }
+
+        size_t handled = 0;
+        while(m_numPending > 0 && m_pending[0].event.time < until){
+            std::pop_heap(first, first + static_cast<std::ptrdiff_t>(m_numPending--), later);
+            handler(std::as_const(m_pending[m_numPending].event));
+            handled++;
+        }
+        return handled;
+    }
+
+    template<typename Payload, size_t Capacity>
+    void EventQueue<Payload, Capacity>::wait() {
+        // the signal is read before checking the slot, a push in between changes it so wait returns
+        const auto signal = m_signal.load(std::memory_order_acquire);
+        if(m_numPending > 0 || published()) return;
+        m_signal.wait(signal, std::memory_order_acquire);
+    }
+
+    template<typename Payload, size_t Capacity>
+    void EventQueue<Payload, Capacity>::wake() {
+        m_signal.fetch_add(1, std::memory_order_release);
+        m_signal.notify_all();
+    }
+
+    template<typename Payload, size_t Capacity>
+    size_t EventQueue<Payload, Capacity>::pending() const {
+        return m_numPending;
+    }
+}
@@ -4,6 +4,7 @@
 #include "constants.h"
 #include <numeric>
 #include <functional>
+#include "sample_buffer.h"
 
 namespace dsp {
     enum class FFTType { FORWARD, INVERSE};
@@ -82,6 +83,15 @@ namespace dsp {
         }
     }
 
+    /**
+     * transforms the samples of a view, which may be strided, e.g. one channel of interleaved frames
+     */
+    template<FFTType type = FFTType::FORWARD, typename SampleType, typename ComplexIterator>
+    void fft(SampleBufferView<SampleType> samples, ComplexIterator c_out, int nf){
+        using Iterator = typename SampleBufferView<SampleType>::iterator;
+        fft<Iterator, ComplexIterator, type>(samples.begin(), samples.end(), c_out, nf);
+    }
+
     std::vector<std::complex<double>> shift(std::vector<std::complex<double>> data){
         std::vector<std::complex<double>> output(data.size());
         const auto N = data.size();
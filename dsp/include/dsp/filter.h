@@ -6,6 +6,9 @@
 #include "constants.h"
 #include <cmath>
 #include <numeric>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
 
 namespace dsp::filter {
 
@@ -19,15 +22,43 @@ namespace dsp::filter {
         MovingAverageFilter(size_t numPoints = 1);
 
         template<typename SampleType>
-        SampleBuffer<SampleType> operator()(SampleBuffer<SampleType>& sampleBuffer);
+        SampleBuffer<SampleType> operator()(const SampleBuffer<SampleType>& sampleBuffer);
 
         template<typename SampleType>
-        SampleBuffer<SampleType> apply(SampleBuffer<SampleType>& sampleBuffer);
+        SampleBuffer<SampleType> apply(const SampleBuffer<SampleType>& sampleBuffer);
+
+        /**
+         * filters input into output, resizing it, output may be input
+         */
+        template<typename SampleType>
+        void apply(const SampleBuffer<SampleType>& input, SampleBuffer<SampleType>& output);
+
+        /**
+         * the first and last numPoints / 2 outputs are zero, input and output may be the same buffer
+         */
+        template<typename SampleType>
+        void process(const SampleType* input, SampleType* output, size_t numSamples);
+
+        /**
+         * input and output may be strided and may be the same samples
+         */
+        template<typename SampleType>
+        void process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output);
+
+        template<typename SampleType>
+        void process(SampleBufferView<SampleType> samples);
 
         void numPoints(size_t n);
 
+    private:
+        template<typename Input, typename Output>
+        void processSamples(Input input, Output output, size_t numSamples);
+
     private:
         size_t m_numPoints;
+
+        // inputs still inside the averaging window, so output can overwrite input
+        std::vector<double> m_window;
     };
 
     template<InversionType InversionType = InversionType::None>
@@ -37,23 +68,52 @@ namespace dsp::filter {
 
         SincFilter() = default;
 
-        SincFilter(double cf, size_t length);
+        SincFilter(double cf, size_t length, WindowType window = WindowType::BlackMan);
 
         void cutoffFrequency(double cf);
 
         void length(size_t length);
 
+        void window(WindowType window);
+
         template<typename SampleType>
-        SampleBuffer<SampleType> apply(SampleBuffer<SampleType>& sampleBuffer);
+        SampleBuffer<SampleType> apply(const SampleBuffer<SampleType>& sampleBuffer);
 
+        /**
+         * filters input into output, resizing it, output may be input
+         */
+        template<typename SampleType>
+        void apply(const SampleBuffer<SampleType>& input, SampleBuffer<SampleType>& output);
+
+        /**
+         * the first kernel().size() - 1 outputs are zero, input and output may be the same buffer
+         */
+        template<typename SampleType>
+        void process(const SampleType* input, SampleType* output, size_t numSamples);
+
+        /**
+         * input and output may be strided and may be the same samples
+         */
+        template<typename SampleType>
+        void process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output);
+
+        template<typename SampleType>
+        void process(SampleBufferView<SampleType> samples);
 
         [[nodiscard]]
         std::vector<double> kernel() const;
 
+    private:
+        void design();
+
+        template<typename Input, typename Output>
+        void processSamples(Input input, Output output, size_t numSamples);
+
     private:
         double m_cutoffFrequency{0};
-        std::vector<double> m_kernel{};
+        SharedKernel m_kernel{ std::make_shared<const std::vector<double>>() };
         size_t m_length{0};
+        WindowType m_window{ WindowType::BlackMan };
     };
 
 //==============================================================================
@@ -66,82 +126,186 @@ namespace dsp::filter {
 //   Code beyond this point is implementation detail...
 //
 //==============================================================================
-    MovingAverageFilter::MovingAverageFilter(size_t numPoints)
-            : m_numPoints(numPoints | 1) {}
-
-    void MovingAverageFilter::numPoints(size_t n) {
-        m_numPoints = n;
+    inline MovingAverageFilter::MovingAverageFilter(size_t numPoints)
+            : m_numPoints(numPoints | 1)
+            , m_window(m_numPoints)
+    {}
+
+    inline void MovingAverageFilter::numPoints(size_t n) {
+        m_numPoints = n | 1;
+        m_window.resize(m_numPoints);
     }
 
     template<typename SampleType>
-    SampleBuffer <SampleType> MovingAverageFilter::operator()(SampleBuffer <SampleType> &sampleBuffer) {
+    SampleBuffer <SampleType> MovingAverageFilter::operator()(const SampleBuffer <SampleType> &sampleBuffer) {
         return apply(sampleBuffer);
     }
 
     template<typename SampleType>
-    SampleBuffer <SampleType> MovingAverageFilter::apply(SampleBuffer <SampleType> &sampleBuffer) {
-        const auto N = sampleBuffer.size();
+    SampleBuffer <SampleType> MovingAverageFilter::apply(const SampleBuffer <SampleType> &sampleBuffer) {
+        SampleBuffer <SampleType> output(sampleBuffer.size());
+        process(sampleBuffer.data(), output.data(), sampleBuffer.size());
+
+        return output;
+    }
+
+    template<typename SampleType>
+    void MovingAverageFilter::apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output) {
+        output.resize(input.size());
+        process(input.data(), output.data(), input.size());
+    }
+
+    template<typename SampleType>
+    void MovingAverageFilter::process(const SampleType *input, SampleType *output, size_t numSamples) {
+        processSamples(input, output, numSamples);
+    }
+
+    template<typename SampleType>
+    void MovingAverageFilter::process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            processSamples(input.data(), output.data(), input.size());
+        }else {
+            processSamples(input, output, input.size());
+        }
+    }
+
+    template<typename SampleType>
+    void MovingAverageFilter::process(SampleBufferView<SampleType> samples) {
+        process<SampleType>(samples, samples);
+    }
+
+    template<typename Input, typename Output>
+    void MovingAverageFilter::processSamples(Input input, Output output, size_t numSamples) {
+        using SampleType = std::remove_cvref_t<decltype(output[0])>;
+        const auto N = numSamples;
         const auto M = m_numPoints;
-        const auto &input = sampleBuffer;
-        SampleBuffer <SampleType> output(N);
+        const auto mid = M / 2;
+        if(N < M){
+            for(size_t i = 0; i < N; i++) output[i] = SampleType{};
+            return;
+        }
 
+        // input[i + mid] is always read before output[i + mid] is written, the samples leaving
+        // the window come from m_window as output may have overwritten them already
+        auto window = m_window.data();
         SampleType sum{};
-        for (int i = 0; i < M; i++) {
+        for (size_t i = 0; i < M; i++) {
+            window[i] = input[i];
             sum += input[i];
         }
-        auto mid = M / 2;
+        for(size_t i = 0; i < mid; i++) output[i] = SampleType{};
         output[mid] = sum / static_cast<SampleType>(M);
 
+        size_t oldest = 0;
         for (auto i = mid + 1; i < (N - mid); i++) {
-            sum += input[i + mid] - input[i - mid - 1];
+            const auto next = input[i + mid];
+            sum += next - static_cast<SampleType>(window[oldest]);
+            window[oldest] = next;
+            oldest = oldest + 1 == M ? 0 : oldest + 1;
             output[i] = sum / static_cast<SampleType>(M);
         }
-
-        return output;
+        for(auto i = N - mid; i < N; i++) output[i] = SampleType{};
     }
 
     template<InversionType InversionType>
-     SincFilter<InversionType>::SincFilter(double cf, size_t length)
+     SincFilter<InversionType>::SincFilter(double cf, size_t length, WindowType window)
             : m_cutoffFrequency(cf)
             , m_length(length)
+            , m_window(window)
     {
-        m_kernel = sinc<InversionType>(cf, int(length));
+        design();
     }
 
     template<InversionType InversionType>
     void SincFilter<InversionType>::cutoffFrequency(double cf) {
         m_cutoffFrequency = cf;
-        sinc(m_cutoffFrequency, m_length);
+        design();
     }
 
     template<InversionType InversionType>
     void SincFilter<InversionType>::length(size_t length) {
         m_length = length;
-        sinc(m_cutoffFrequency, m_length);
+        design();
+    }
+
+    template<InversionType InversionType>
+    void SincFilter<InversionType>::window(WindowType window) {
+        m_window = window;
+        design();
+    }
+
+    template<InversionType InversionType>
+    void SincFilter<InversionType>::design() {
+        m_kernel = sincKernel<InversionType>(m_cutoffFrequency, int(m_length), m_window);
     }
 
     template<InversionType InversionType>
     template<typename SampleType>
-    SampleBuffer<SampleType> SincFilter<InversionType>::apply(SampleBuffer<SampleType> &sampleBuffer) {
+    SampleBuffer<SampleType> SincFilter<InversionType>::apply(const SampleBuffer<SampleType> &sampleBuffer) {
         SampleBuffer<SampleType> output(sampleBuffer.size());
-        const auto& X = sampleBuffer;
-        const auto& H = m_kernel;
-        auto& Y = output;
-        const auto N = sampleBuffer.size();
-        const auto M = m_kernel.size() - 1;
-
-        for(auto j = M; j < N; j++){
-            for(auto i = 0; i <= M; i++){
-                Y[j] = Y[j] + X[j - i] * H[i];
-            }
-        }
+        process(sampleBuffer.data(), output.data(), sampleBuffer.size());
 
         return output;
     }
 
+    template<InversionType InversionType>
+    template<typename SampleType>
+    void SincFilter<InversionType>::apply(const SampleBuffer<SampleType> &input, SampleBuffer<SampleType> &output) {
+        output.resize(input.size());
+        process(input.data(), output.data(), input.size());
+    }
+
+    template<InversionType InversionType>
+    template<typename SampleType>
+    void SincFilter<InversionType>::process(const SampleType *input, SampleType *output, size_t numSamples) {
+        processSamples(input, output, numSamples);
+    }
+
+    template<InversionType InversionType>
+    template<typename SampleType>
+    void SincFilter<InversionType>::process(SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            processSamples(input.data(), output.data(), input.size());
+        }else {
+            processSamples(input, output, input.size());
+        }
+    }
+
+    template<InversionType InversionType>
+    template<typename SampleType>
+    void SincFilter<InversionType>::process(SampleBufferView<SampleType> samples) {
+        process<SampleType>(samples, samples);
+    }
+
+    template<InversionType InversionType>
+    template<typename Input, typename Output>
+    void SincFilter<InversionType>::processSamples(Input input, Output output, size_t numSamples) {
+        using SampleType = std::remove_cvref_t<decltype(output[0])>;
+        const auto& H = *m_kernel;
+        const auto N = numSamples;
+        const auto M = H.size() - 1;
+        if(H.empty() || N <= M){
+            for(size_t i = 0; i < N; i++) output[i] = SampleType{};
+            return;
+        }
+
+        // newest first, output[j] only depends on inputs at or before j so in place filtering
+        // never reads a sample it already overwrote
+        for(auto j = N; j-- > M;){
+            double sum{};
+            for(size_t i = 0; i <= M; i++){
+                sum += input[j - i] * H[i];
+            }
+            output[j] = static_cast<SampleType>(sum);
+        }
+        for(size_t j = 0; j < M; j++) output[j] = SampleType{};
+    }
+
     template<InversionType InversionType>
     std::vector<double> SincFilter<InversionType>::kernel() const {
-        return m_kernel;
+        return *m_kernel;
     }
 }
 
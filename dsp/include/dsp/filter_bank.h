@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include "coefficients.h"
+#include "denormal.h"
+
+namespace dsp {
+
+    /**
+     * The immutable part of a recursive filter, shared by every channel filtered with it
+     */
+    template<size_t Poles>
+    struct Design {
+        std::array<double, Poles + 1u> a{};
+        std::array<double, Poles + 1u> b{};
+
+        double c0{1};
+        double d0{0};
+
+        template<typename Real>
+        static Design from(const Coefficients<Poles, Real>& coefficients);
+
+        static constexpr size_t poles = Poles;
+    };
+
+    /**
+     * Filter state for numChannels channels sharing one Design.
+     *
+     * History is kept as Poles + 1 planes of numChannels samples for the input and for the output,
+     * rotated through a single head index shared by all channels, so every tap is one pass over a
+     * contiguous run of channels.
+     */
+    template<size_t Poles, typename SampleType = float>
+    class FilterBank {
+    public:
+        static_assert(std::is_floating_point_v<SampleType>, "SampleType should be floating point type");
+
+        FilterBank(std::shared_ptr<const Design<Poles>> design, size_t numChannels);
+
+        template<typename Real>
+        FilterBank(const Coefficients<Poles, Real>& coefficients, size_t numChannels);
+
+        /**
+         * input and output hold numFrames frames of numChannels interleaved samples
+         */
+        void process(const SampleType* input, SampleType* output, size_t numFrames);
+
+        void reset();
+
+        [[nodiscard]]
+        size_t numChannels() const;
+
+        [[nodiscard]]
+        const Design<Poles>& design() const;
+
+        // channels processed together for a whole block, small enough for their state to stay in L1
+        static constexpr size_t TileSize = 256;
+
+    private:
+        SampleType* plane(std::vector<SampleType>& history, size_t index);
+
+    private:
+        static constexpr size_t N = Poles + 1u;
+
+        std::shared_ptr<const Design<Poles>> m_design;
+        size_t m_numChannels;
+        std::vector<SampleType> m_x;
+        std::vector<SampleType> m_y;
+        size_t m_head{0};
+    };
+
+    template<size_t Poles>
+    template<typename Real>
+    Design<Poles> Design<Poles>::from(const Coefficients<Poles, Real> &coefficients) {
+        Design design{};
+        std::copy(coefficients.a.begin(), coefficients.a.end(), design.a.begin());
+        std::copy(coefficients.b.begin(), coefficients.b.end(), design.b.begin());
+        design.c0 = coefficients.c0;
+        design.d0 = coefficients.d0;
+
+        return design;
+    }
+
+    template<size_t Poles, typename SampleType>
+    FilterBank<Poles, SampleType>::FilterBank(std::shared_ptr<const Design<Poles>> design, size_t numChannels)
+    : m_design{ std::move(design) }
+    , m_numChannels{ numChannels }
+    , m_x(N * numChannels)
+    , m_y(N * numChannels)
+    {
+        assert(m_design);
+    }
+
+    template<size_t Poles, typename SampleType>
+    template<typename Real>
+    FilterBank<Poles, SampleType>::FilterBank(const Coefficients<Poles, Real> &coefficients, size_t numChannels)
+    : FilterBank(std::make_shared<const Design<Poles>>(Design<Poles>::from(coefficients)), numChannels)
+    {}
+
+    template<size_t Poles, typename SampleType>
+    SampleType *FilterBank<Poles, SampleType>::plane(std::vector<SampleType> &history, size_t index) {
+        return history.data() + (index % N) * m_numChannels;
+    }
+
+    template<size_t Poles, typename SampleType>
+    void FilterBank<Poles, SampleType>::process(const SampleType *input, SampleType *output, size_t numFrames) {
+        const auto& design = *m_design;
+        const auto C = m_numChannels;
+
+        std::array<SampleType, N> A{};
+        std::array<SampleType, N> B{};
+        std::copy(design.a.begin(), design.a.end(), A.begin());
+        std::copy(design.b.begin(), design.b.end(), B.begin());
+        const auto c0 = static_cast<SampleType>(design.c0);
+        const auto d0 = static_cast<SampleType>(design.d0);
+
+        for(size_t first = 0; first < C; first += TileSize){
+            const auto last = std::min(C, first + TileSize);
+            const auto width = last - first;
+            auto head = m_head;
+
+            for(size_t i = 0; i < numFrames; i++){
+                head = head == 0 ? N - 1 : head - 1;
+                auto X = plane(m_x, head) + first;
+                auto Y = plane(m_y, head) + first;
+                auto in = input + i * C + first;
+                auto out = output + i * C + first;
+
+                for(size_t c = 0; c < width; c++){
+                    X[c] = in[c];
+                    Y[c] = A[0] * in[c];
+                }
+                for(size_t k = 1; k < N; k++){
+                    const auto Xk = plane(m_x, head + k) + first;
+                    const auto Yk = plane(m_y, head + k) + first;
+                    const auto a = A[k];
+                    const auto b = B[k];
+                    for(size_t c = 0; c < width; c++){
+                        Y[c] += a * Xk[c] + b * Yk[c];
+                    }
+                }
+                for(size_t c = 0; c < width; c++){
+                    antiDenormal(Y[c]);
+                    out[c] = Y[c] * c0 + X[c] * d0;
+                }
+            }
+        }
+
+        m_head = (m_head + N - numFrames % N) % N;
+    }
+
+    template<size_t Poles, typename SampleType>
+    void FilterBank<Poles, SampleType>::reset() {
+        std::fill(m_x.begin(), m_x.end(), SampleType{});
+        std::fill(m_y.begin(), m_y.end(), SampleType{});
+        m_head = 0;
+    }
+
+    template<size_t Poles, typename SampleType>
+    size_t FilterBank<Poles, SampleType>::numChannels() const {
+        return m_numChannels;
+    }
+
+    template<size_t Poles, typename SampleType>
+    const Design<Poles> &FilterBank<Poles, SampleType>::design() const {
+        return *m_design;
+    }
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include "sample_buffer.h"
+#include "audio_block.h"
+#include "parallel.h"
+
+namespace dsp {
+
+    /**
+     * Zero phase filtering, runs filter forward and then backward over the signal so its
+     * magnitude response is squared and its phase cancels out.
+     *
+     * Both ends are extended by an odd reflection of 3 * poles samples and each pass starts primed
+     * to the steady state of its first sample, so the output has no start up transient at either edge.
+     * Filter is a Coefficients or a Cascade, it is copied so the caller's filter state is untouched.
+     *
+     * Only the 3 * poles padding samples are buffered, the backward pass runs in place on output,
+     * input and output may be the same buffer.
+     */
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, const SampleType* input, SampleType* output, size_t numSamples);
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output);
+
+    /**
+     * input and output may be strided, e.g. one channel of interleaved frames
+     */
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output);
+
+    template<typename Filter, typename SampleType>
+    SampleBuffer<SampleType> filtfilt(const Filter& filter, const SampleBuffer<SampleType>& input);
+
+    /**
+     * filters numChannels planar channels of numSamples each, channels are spread across numThreads threads
+     */
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, const SampleType* const* inputs, SampleType* const* outputs, size_t numChannels
+                  , size_t numSamples, unsigned numThreads = std::thread::hardware_concurrency());
+
+    /**
+     * filters every channel of a planar block, channels are spread across numThreads threads
+     */
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, AudioBlockView<const std::type_identity_t<SampleType>> input, AudioBlockView<SampleType> output
+                  , unsigned numThreads = std::thread::hardware_concurrency());
+
+    /**
+     * filters every signal in place, signals may differ in length and are spread across numThreads threads
+     */
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, std::vector<SampleBuffer<SampleType>>& signals
+                  , unsigned numThreads = std::thread::hardware_concurrency());
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, const SampleType* input, SampleType* output, size_t numSamples) {
+        filtfilt<Filter, SampleType>(filter, SampleBufferView<const SampleType>{ input, numSamples }, SampleBufferView<SampleType>{ output, numSamples });
+    }
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output) {
+        constexpr size_t MaxPad = 3 * Filter::poles;
+        constexpr size_t BlockSize = 256;
+
+        assert(output.size() >= input.size());
+        const auto numSamples = input.size();
+        if(numSamples == 0) return;
+
+        // taken before the forward pass, which may overwrite input
+        const auto pad = std::min(MaxPad, numSamples - 1);
+        const double first = input[0];
+        const double last = input[numSamples - 1];
+        std::array<double, MaxPad> head{};
+        std::array<double, MaxPad> tail{};
+        for(size_t i = 0; i < pad; i++){
+            head[i] = 2 * first - input[pad - i];
+            tail[i] = 2 * last - input[numSamples - 2 - i];
+        }
+
+        auto forward = filter;
+        forward.prime(pad > 0 ? head[0] : first);
+        forward.process(head.data(), head.data(), pad);
+        forward.template process<SampleType>(input, output.subview(0, numSamples));
+        forward.process(tail.data(), tail.data(), pad);
+
+        auto backward = filter;
+        backward.prime(pad > 0 ? tail[pad - 1] : static_cast<double>(output[numSamples - 1]));
+        std::reverse(tail.begin(), tail.begin() + pad);
+        backward.process(tail.data(), tail.data(), pad);
+
+        // reversed a block at a time so the backward pass still runs through process
+        std::array<double, BlockSize> block;
+        for(auto end = numSamples; end > 0;){
+            const auto N = std::min(BlockSize, end);
+            const auto begin = end - N;
+            std::reverse_copy(output.begin() + begin, output.begin() + end, block.begin());
+            backward.process(block.data(), block.data(), N);
+            std::reverse_copy(block.begin(), block.begin() + N, output.begin() + begin);
+            end = begin;
+        }
+    }
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output) {
+        assert(output.size() >= input.size());
+        filtfilt(filter, input.data(), output.data(), input.size());
+    }
+
+    template<typename Filter, typename SampleType>
+    SampleBuffer<SampleType> filtfilt(const Filter& filter, const SampleBuffer<SampleType>& input) {
+        SampleBuffer<SampleType> output(input.size());
+        filtfilt(filter, input.data(), output.data(), input.size());
+
+        return output;
+    }
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, const SampleType* const* inputs, SampleType* const* outputs, size_t numChannels
+                  , size_t numSamples, unsigned numThreads) {
+        parallelFor(numChannels, [&](size_t first, size_t last){
+            for(auto channel = first; channel < last; channel++){
+                filtfilt(filter, inputs[channel], outputs[channel], numSamples);
+            }
+        }, numThreads);
+    }
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, AudioBlockView<const std::type_identity_t<SampleType>> input, AudioBlockView<SampleType> output
+                  , unsigned numThreads) {
+        assert(output.numChannels() >= input.numChannels());
+        parallelFor(input.numChannels(), [&](size_t first, size_t last){
+            for(auto channel = first; channel < last; channel++){
+                filtfilt<Filter, SampleType>(filter, input.channel(channel), output.channel(channel));
+            }
+        }, numThreads);
+    }
+
+    template<typename Filter, typename SampleType>
+    void filtfilt(const Filter& filter, std::vector<SampleBuffer<SampleType>>& signals, unsigned numThreads) {
+        parallelFor(signals.size(), [&](size_t first, size_t last){
+            for(auto i = first; i < last; i++){
+                auto& signal = signals[i];
+                filtfilt(filter, signal.data(), signal.data(), signal.size());
+            }
+        }, numThreads);
+    }
+}
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include "constants.h"
+#include "coefficients.h"
+#include "cascade.h"
+
+namespace dsp {
+
+    /**
+     * Response of a filter evaluated analytically from its transfer function,
+     * frequencies are fractions of the sample rate in [0, 0.5]
+     */
+    struct FrequencyResponse {
+        std::vector<double> frequency;
+        std::vector<double> magnitude;
+
+        // radians, wrapped to (-PI, PI]
+        std::vector<double> phase;
+
+        // samples
+        std::vector<double> groupDelay;
+
+        [[nodiscard]]
+        size_t size() const;
+    };
+
+    std::vector<double> linearFrequencies(size_t count, double first = 0, double last = 0.5);
+
+    std::vector<double> logFrequencies(size_t count, double first, double last = 0.5);
+
+    /**
+     * Evaluates H(z) = N(z^-1) / D(z^-1) on the unit circle, numerator and denominator
+     * hold the polynomial coefficients in increasing powers of z^-1
+     */
+    FrequencyResponse frequencyResponse(std::span<const double> numerator, std::span<const double> denominator
+                                        , std::span<const double> frequencies);
+
+    /**
+     * response of an FIR kernel
+     */
+    FrequencyResponse frequencyResponse(std::span<const double> kernel, std::span<const double> frequencies);
+
+    template<size_t Poles, typename Real>
+    FrequencyResponse frequencyResponse(const Coefficients<Poles, Real>& filter, std::span<const double> frequencies);
+
+    template<size_t Sections, typename Real>
+    FrequencyResponse frequencyResponse(const Cascade<Sections, Real>& filter, std::span<const double> frequencies);
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    namespace details {
+
+        /**
+         * Product of rational responses accumulated one factor at a time. Frequencies are
+         * evaluated in tiles of TileSize with the real and imaginary parts in separate local
+         * arrays, so each Horner step vectorizes across a tile of frequencies instead of
+         * running one complex Horner scheme per frequency.
+         */
+        class ResponseAccumulator {
+        public:
+            explicit ResponseAccumulator(std::span<const double> frequencies);
+
+            void multiply(std::span<const double> numerator, std::span<const double> denominator);
+
+            FrequencyResponse result() const;
+
+            static constexpr size_t TileSize = 64;
+
+        private:
+            // multiplies the response by the polynomial, or divides it when divide is set, and
+            // adds (subtracts) the polynomial's group delay
+            void apply(std::span<const double> polynomial, bool divide);
+
+        private:
+            std::span<const double> m_frequencies;
+
+            // padded to a whole number of tiles, u = e^-jw
+            std::vector<double> m_cos, m_sin;
+            std::vector<double> m_re, m_im, m_delay;
+        };
+
+        inline ResponseAccumulator::ResponseAccumulator(std::span<const double> frequencies)
+        : m_frequencies{ frequencies }
+        {
+            const auto padded = (frequencies.size() + TileSize - 1) / TileSize * TileSize;
+            m_cos.resize(padded, 1.0);
+            m_sin.resize(padded, 0.0);
+            m_re.resize(padded, 1.0);
+            m_im.resize(padded, 0.0);
+            m_delay.resize(padded, 0.0);
+
+            for(size_t i = 0; i < frequencies.size(); i++){
+                const auto w = _2_PI * frequencies[i];
+                m_cos[i] = std::cos(w);
+                m_sin[i] = -std::sin(w);
+            }
+        }
+
+        inline void ResponseAccumulator::multiply(std::span<const double> numerator, std::span<const double> denominator) {
+            apply(numerator, false);
+            apply(denominator, true);
+        }
+
+        inline void ResponseAccumulator::apply(std::span<const double> polynomial, bool divide) {
+            if(polynomial.empty()) return;
+
+            constexpr auto T = TileSize;
+            const auto last = polynomial.size() - 1;
+            const double sign = divide ? -1 : 1;
+
+            for(size_t first = 0; first < m_cos.size(); first += T){
+                std::array<double, T> ur, ui;
+                std::array<double, T> pr, pi, dr{}, di{};
+                std::copy_n(m_cos.data() + first, T, ur.data());
+                std::copy_n(m_sin.data() + first, T, ui.data());
+                pr.fill(polynomial[last]);
+                pi.fill(0);
+
+                // Horner's scheme for p(u) and p'(u) together, highest power first
+                for(size_t k = last; k > 0; --k){
+                    const auto c = polynomial[k - 1];
+                    for(size_t i = 0; i < T; i++){
+                        const auto dR = dr[i] * ur[i] - di[i] * ui[i] + pr[i];
+                        const auto dI = dr[i] * ui[i] + di[i] * ur[i] + pi[i];
+                        const auto pR = pr[i] * ur[i] - pi[i] * ui[i] + c;
+                        const auto pI = pr[i] * ui[i] + pi[i] * ur[i];
+                        dr[i] = dR, di[i] = dI;
+                        pr[i] = pR, pi[i] = pI;
+                    }
+                }
+
+                const auto re = m_re.data() + first;
+                const auto im = m_im.data() + first;
+                const auto delay = m_delay.data() + first;
+
+                for(size_t i = 0; i < T; i++){
+                    // group delay of p is Re(u * p'(u) / p(u))
+                    const auto uDr = dr[i] * ur[i] - di[i] * ui[i];
+                    const auto uDi = dr[i] * ui[i] + di[i] * ur[i];
+                    const auto norm = pr[i] * pr[i] + pi[i] * pi[i];
+                    const auto inv = norm > 0 ? 1 / norm : 0.0;
+                    delay[i] += sign * (uDr * pr[i] + uDi * pi[i]) * inv;
+
+                    const auto qr = divide ? pr[i] * inv : pr[i];
+                    const auto qi = divide ? -pi[i] * inv : pi[i];
+                    const auto r = re[i] * qr - im[i] * qi;
+                    im[i] = re[i] * qi + im[i] * qr;
+                    re[i] = r;
+                }
+            }
+        }
+
+        inline FrequencyResponse ResponseAccumulator::result() const {
+            const auto F = m_frequencies.size();
+            FrequencyResponse response{
+                { m_frequencies.begin(), m_frequencies.end() }
+                , std::vector<double>(F)
+                , std::vector<double>(F)
+                , std::vector<double>(m_delay.begin(), m_delay.begin() + F)
+            };
+
+            for(size_t i = 0; i < F; i++){
+                response.magnitude[i] = std::hypot(m_re[i], m_im[i]);
+                response.phase[i] = std::atan2(m_im[i], m_re[i]);
+            }
+            return response;
+        }
+
+        // numerator c0 * A(z) + d0 * D(z) and denominator D(z) = 1 - sum(b[k] z^-k) of a direct form filter
+        template<size_t Poles, typename Real>
+        void multiply(ResponseAccumulator& accumulator, const Coefficients<Poles, Real>& filter) {
+            constexpr auto N = Poles + 1u;
+            std::array<double, N> numerator{};
+            std::array<double, N> denominator{};
+
+            denominator[0] = 1;
+            for(size_t k = 1; k < N; k++){
+                denominator[k] = -filter.b[k];
+            }
+            for(size_t k = 0; k < N; k++){
+                numerator[k] = static_cast<double>(filter.c0) * filter.a[k] + filter.d0 * denominator[k];
+            }
+            accumulator.multiply(numerator, denominator);
+        }
+    }
+
+    inline size_t FrequencyResponse::size() const {
+        return frequency.size();
+    }
+
+    inline std::vector<double> linearFrequencies(size_t count, double first, double last) {
+        std::vector<double> frequencies(count);
+        const auto step = count > 1 ? (last - first) / static_cast<double>(count - 1) : 0.0;
+        for(size_t i = 0; i < count; i++){
+            frequencies[i] = first + step * static_cast<double>(i);
+        }
+        return frequencies;
+    }
+
+    inline std::vector<double> logFrequencies(size_t count, double first, double last) {
+        assert(first > 0 && last > 0);
+
+        std::vector<double> frequencies(count);
+        const auto ratio = count > 1 ? std::pow(last / first, 1.0 / static_cast<double>(count - 1)) : 1.0;
+        auto f = first;
+        for(size_t i = 0; i < count; i++){
+            frequencies[i] = f;
+            f *= ratio;
+        }
+        return frequencies;
+    }
+
+    inline FrequencyResponse frequencyResponse(std::span<const double> numerator, std::span<const double> denominator
+                                               , std::span<const double> frequencies) {
+        details::ResponseAccumulator accumulator{ frequencies };
+        accumulator.multiply(numerator, denominator);
+        return accumulator.result();
+    }
+
+    inline FrequencyResponse frequencyResponse(std::span<const double> kernel, std::span<const double> frequencies) {
+        constexpr double one = 1;
+        return frequencyResponse(kernel, std::span<const double>{ &one, 1 }, frequencies);
+    }
+
+    template<size_t Poles, typename Real>
+    FrequencyResponse frequencyResponse(const Coefficients<Poles, Real>& filter, std::span<const double> frequencies) {
+        details::ResponseAccumulator accumulator{ frequencies };
+        details::multiply(accumulator, filter);
+        return accumulator.result();
+    }
+
+    template<size_t Sections, typename Real>
+    FrequencyResponse frequencyResponse(const Cascade<Sections, Real>& filter, std::span<const double> frequencies) {
+        details::ResponseAccumulator accumulator{ frequencies };
+        for(const auto& section : filter.sections){
+            details::multiply(accumulator, section);
+        }
+        return accumulator.result();
+    }
+}
@@ -0,0 +1,445 @@
+#pragma once
+
+#include <bit>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <fstream>
+#include <utility>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include "sample_buffer.h"
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define DSP_HAS_MAPPED_FILES 1
+#endif
+
+namespace dsp {
+
+    /**
+     * Read only samples backed by a memory mapped file, opening one maps the file and reads at most
+     * the WAV header, samples are paged in from the page cache as they are first touched so even
+     * multi gigabyte captures open immediately and never need a second copy in memory.
+     *
+     * raw() maps headerless interleaved samples, wav() the data chunk of a WAV file whose sample
+     * format matches SampleType: float or double for IEEE float files, int16_t or int32_t for PCM.
+     * Interleaved channels are available as strided views through channel(), so filters and the
+     * fft read them in place.
+     *
+     * Where files can't be mapped (Windows, or a data chunk that isn't aligned for SampleType)
+     * the samples are read into memory instead, everything else behaves the same.
+     */
+    template<typename SampleType = float>
+    class MappedSampleBuffer {
+    public:
+        static_assert(std::is_arithmetic_v<SampleType>, "SampleType should be an arithmetic type");
+
+        enum class Access { Normal, Sequential, Random, WillNeed };
+
+        /**
+         * maps the whole file after offset bytes as interleaved frames of numChannels samples
+         */
+        static MappedSampleBuffer raw(const std::filesystem::path& path, size_t numChannels = 1, size_t offset = 0);
+
+        /**
+         * maps the data chunk of a WAV file, throws std::runtime_error if it isn't a WAV file or its
+         * sample format doesn't match SampleType
+         */
+        static MappedSampleBuffer wav(const std::filesystem::path& path);
+
+        MappedSampleBuffer() = default;
+
+        ~MappedSampleBuffer();
+
+        MappedSampleBuffer(const MappedSampleBuffer&) = delete;
+
+        MappedSampleBuffer& operator=(const MappedSampleBuffer&) = delete;
+
+        MappedSampleBuffer(MappedSampleBuffer&& other) noexcept;
+
+        MappedSampleBuffer& operator=(MappedSampleBuffer&& other) noexcept;
+
+        /**
+         * total number of samples, numFrames() * numChannels()
+         */
+        [[nodiscard]]
+        size_t size() const noexcept;
+
+        [[nodiscard]]
+        bool empty() const noexcept;
+
+        [[nodiscard]]
+        size_t numChannels() const noexcept;
+
+        [[nodiscard]]
+        size_t numFrames() const noexcept;
+
+        /**
+         * from the WAV header, 0 for raw files
+         */
+        [[nodiscard]]
+        uint32_t sampleRate() const noexcept;
+
+        [[nodiscard]]
+        const SampleType* data() const noexcept;
+
+        const SampleType& operator[](size_t idx) const;
+
+        [[nodiscard]]
+        SampleBufferView<const SampleType> view() const noexcept;
+
+        /**
+         * every numChannels()'th sample starting at channel
+         */
+        [[nodiscard]]
+        SampleBufferView<const SampleType> channel(size_t index) const;
+
+        [[nodiscard]]
+        std::span<const SampleType> span() const noexcept;
+
+        const SampleType* begin() const noexcept;
+
+        const SampleType* end() const noexcept;
+
+        /**
+         * true when the samples are mapped rather than read into memory
+         */
+        [[nodiscard]]
+        bool isMapped() const noexcept;
+
+        /**
+         * hints the kernel how the samples will be read, files are mapped for Sequential access
+         */
+        void advise(Access access) const;
+
+    private:
+        void map(const std::filesystem::path& path, size_t offset, size_t numBytes);
+
+        void release() noexcept;
+
+    private:
+        const SampleType* m_data{nullptr};
+        size_t m_size{0};
+        size_t m_numChannels{1};
+        uint32_t m_sampleRate{0};
+
+        void* m_mapping{nullptr};
+        size_t m_mappingSize{0};
+        std::vector<SampleType> m_samples;
+    };
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    namespace details {
+
+        struct WavLayout {
+            uint16_t format{0};
+            uint16_t numChannels{0};
+            uint32_t sampleRate{0};
+            uint16_t bitsPerSample{0};
+            size_t dataOffset{0};
+            size_t dataSize{0};
+        };
+
+        inline uint32_t readLE(const unsigned char* bytes, size_t count) {
+            uint32_t value = 0;
+            for(size_t i = 0; i < count; i++){
+                value |= static_cast<uint32_t>(bytes[i]) << (8 * i);
+            }
+            return value;
+        }
+
+        // walks the RIFF chunks up to the data chunk, only the headers are read
+        inline WavLayout readWavLayout(const std::filesystem::path& path) {
+            constexpr uint16_t FormatExtensible = 0xFFFE;
+
+            std::ifstream file{ path, std::ios::binary };
+            if(!file){
+                throw std::system_error(errno, std::generic_category(), "unable to open " + path.string());
+            }
+            const auto fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+
+            unsigned char header[12];
+            if(!file.read(reinterpret_cast<char*>(header), sizeof(header))
+                || std::memcmp(header, "RIFF", 4) != 0 || std::memcmp(header + 8, "WAVE", 4) != 0){
+                throw std::runtime_error(path.string() + " is not a WAV file");
+            }
+
+            WavLayout layout{};
+            bool hasFormat = false;
+            size_t position = sizeof(header);
+            unsigned char chunk[8];
+            while(file.read(reinterpret_cast<char*>(chunk), sizeof(chunk))){
+                const size_t chunkSize = readLE(chunk + 4, 4);
+                position += sizeof(chunk);
+
+                if(std::memcmp(chunk, "fmt ", 4) == 0){
+                    unsigned char fmt[26]{};
+                    file.read(reinterpret_cast<char*>(fmt), static_cast<std::streamsize>(std::min(chunkSize, sizeof(fmt))));
+                    layout.format = static_cast<uint16_t>(readLE(fmt, 2));
+                    layout.numChannels = static_cast<uint16_t>(readLE(fmt + 2, 2));
+                    layout.sampleRate = readLE(fmt + 4, 4);
+                    layout.bitsPerSample = static_cast<uint16_t>(readLE(fmt + 14, 2));
+                    if(layout.format == FormatExtensible && chunkSize >= sizeof(fmt)){
+                        // the first two bytes of the sub format GUID are the actual format
+                        layout.format = static_cast<uint16_t>(readLE(fmt + 24, 2));
+                    }
+                    hasFormat = true;
+                }else if(std::memcmp(chunk, "data", 4) == 0){
+                    if(!hasFormat){
+                        throw std::runtime_error(path.string() + " has no fmt chunk before its data");
+                    }
+                    // streamed writers leave the size at 0 or 0xFFFFFFFF, the data then runs to the end
+                    layout.dataOffset = position;
+                    layout.dataSize = chunkSize == 0 || position + chunkSize > fileSize ? fileSize - position : chunkSize;
+                    return layout;
+                }
+
+                position += chunkSize + (chunkSize & 1);
+                file.seekg(static_cast<std::streamoff>(position));
+            }
+            throw std::runtime_error(path.string() + " has no data chunk");
+        }
+
+        template<typename SampleType>
+        bool matchesWavFormat(const WavLayout& layout) {
+            constexpr uint16_t Pcm = 1;
+            constexpr uint16_t IeeeFloat = 3;
+            constexpr auto Bits = 8 * sizeof(SampleType);
+
+            if(layout.bitsPerSample != Bits) return false;
+            if constexpr (std::is_floating_point_v<SampleType>){
+                return layout.format == IeeeFloat;
+            }else {
+                return layout.format == Pcm && std::is_signed_v<SampleType> && Bits >= 16;
+            }
+        }
+    }
+
+    template<typename SampleType>
+    MappedSampleBuffer<SampleType> MappedSampleBuffer<SampleType>::raw(const std::filesystem::path &path, size_t numChannels, size_t offset) {
+        assert(numChannels > 0);
+        const auto fileSize = static_cast<size_t>(std::filesystem::file_size(path));
+        const auto numBytes = fileSize > offset ? fileSize - offset : 0;
+
+        MappedSampleBuffer buffer{};
+        buffer.m_numChannels = numChannels;
+        buffer.map(path, offset, numBytes / (numChannels * sizeof(SampleType)) * numChannels * sizeof(SampleType));
+        return buffer;
+    }
+
+    template<typename SampleType>
+    MappedSampleBuffer<SampleType> MappedSampleBuffer<SampleType>::wav(const std::filesystem::path &path) {
+        if constexpr (std::endian::native != std::endian::little){
+            throw std::runtime_error("mapping WAV samples needs a little endian host");
+        }
+
+        const auto layout = details::readWavLayout(path);
+        if(!details::matchesWavFormat<SampleType>(layout)){
+            throw std::runtime_error(path.string() + " has " + std::to_string(layout.bitsPerSample)
+                                     + " bit samples of format " + std::to_string(layout.format)
+                                     + ", which don't match the requested sample type");
+        }
+        if(layout.numChannels == 0){
+            throw std::runtime_error(path.string() + " has no channels");
+        }
+
+        MappedSampleBuffer buffer{};
+        buffer.m_numChannels = layout.numChannels;
+        buffer.m_sampleRate = layout.sampleRate;
+        const auto frameBytes = layout.numChannels * sizeof(SampleType);
+        buffer.map(path, layout.dataOffset, layout.dataSize / frameBytes * frameBytes);
+        return buffer;
+    }
+
+    template<typename SampleType>
+    void MappedSampleBuffer<SampleType>::map(const std::filesystem::path &path, size_t offset, size_t numBytes) {
+        m_size = numBytes / sizeof(SampleType);
+        if(m_size == 0) return;
+
+#if defined(DSP_HAS_MAPPED_FILES)
+        if(offset % alignof(SampleType) == 0){
+            const auto fd = ::open(path.c_str(), O_RDONLY);
+            if(fd < 0){
+                throw std::system_error(errno, std::generic_category(), "unable to open " + path.string());
+            }
+
+            // mappings start on a page, the samples start offset - pageOffset bytes into it
+            const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            const auto pageOffset = offset / pageSize * pageSize;
+            m_mappingSize = numBytes + (offset - pageOffset);
+
+            const auto mapping = mmap(nullptr, m_mappingSize, PROT_READ, MAP_PRIVATE, fd, static_cast<off_t>(pageOffset));
+            const auto error = errno;
+            ::close(fd);
+            if(mapping == MAP_FAILED){
+                m_mappingSize = 0;
+                throw std::system_error(error, std::generic_category(), "unable to map " + path.string());
+            }
+
+            m_mapping = mapping;
+            m_data = reinterpret_cast<const SampleType*>(static_cast<const char*>(mapping) + (offset - pageOffset));
+            advise(Access::Sequential);
+            return;
+        }
+#endif
+        std::ifstream file{ path, std::ios::binary };
+        if(!file){
+            throw std::system_error(errno, std::generic_category(), "unable to open " + path.string());
+        }
+        m_samples.resize(m_size);
+        file.seekg(static_cast<std::streamoff>(offset));
+        if(!file.read(reinterpret_cast<char*>(m_samples.data()), static_cast<std::streamsize>(numBytes))){
+            throw std::runtime_error("unable to read " + path.string());
+        }
+        m_data = m_samples.data();
+    }
+
+    template<typename SampleType>
+    void MappedSampleBuffer<SampleType>::release() noexcept {
+#if defined(DSP_HAS_MAPPED_FILES)
+        if(m_mapping){
+            munmap(m_mapping, m_mappingSize);
+        }
+#endif
+        m_mapping = nullptr;
+        m_mappingSize = 0;
+        m_data = nullptr;
+        m_size = 0;
+        m_samples.clear();
+    }
+
+    template<typename SampleType>
+    MappedSampleBuffer<SampleType>::~MappedSampleBuffer() {
+        release();
+    }
+
+    template<typename SampleType>
+    MappedSampleBuffer<SampleType>::MappedSampleBuffer(MappedSampleBuffer &&other) noexcept
+            : m_data{ std::exchange(other.m_data, nullptr) }
+            , m_size{ std::exchange(other.m_size, 0) }
+            , m_numChannels{ std::exchange(other.m_numChannels, 1) }
+            , m_sampleRate{ std::exchange(other.m_sampleRate, 0) }
+            , m_mapping{ std::exchange(other.m_mapping, nullptr) }
+            , m_mappingSize{ std::exchange(other.m_mappingSize, 0) }
+            , m_samples{ std::move(other.m_samples) }
+    {}
+
+    template<typename SampleType>
+    MappedSampleBuffer<SampleType>& MappedSampleBuffer<SampleType>::operator=(MappedSampleBuffer &&other) noexcept {
+        if(this != &other){
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_size = std::exchange(other.m_size, 0);
+            m_numChannels = std::exchange(other.m_numChannels, 1);
+            m_sampleRate = std::exchange(other.m_sampleRate, 0);
+            m_mapping = std::exchange(other.m_mapping, nullptr);
+            m_mappingSize = std::exchange(other.m_mappingSize, 0);
+            m_samples = std::move(other.m_samples);
+        }
+        return *this;
+    }
+
+    template<typename SampleType>
+    size_t MappedSampleBuffer<SampleType>::size() const noexcept {
+        return m_size;
+    }
+
+    template<typename SampleType>
+    bool MappedSampleBuffer<SampleType>::empty() const noexcept {
+        return m_size == 0;
+    }
+
+    template<typename SampleType>
+    size_t MappedSampleBuffer<SampleType>::numChannels() const noexcept {
+        return m_numChannels;
+    }
+
+    template<typename SampleType>
+    size_t MappedSampleBuffer<SampleType>::numFrames() const noexcept {
+        return m_size / m_numChannels;
+    }
+
+    template<typename SampleType>
+    uint32_t MappedSampleBuffer<SampleType>::sampleRate() const noexcept {
+        return m_sampleRate;
+    }
+
+    template<typename SampleType>
+    const SampleType* MappedSampleBuffer<SampleType>::data() const noexcept {
+        return m_data;
+    }
+
+    template<typename SampleType>
+    const SampleType& MappedSampleBuffer<SampleType>::operator[](size_t idx) const {
+        assert(idx < m_size);
+        return m_data[idx];
+    }
+
+    template<typename SampleType>
+    SampleBufferView<const SampleType> MappedSampleBuffer<SampleType>::view() const noexcept {
+        return { m_data, m_size };
+    }
+
+    template<typename SampleType>
+    SampleBufferView<const SampleType> MappedSampleBuffer<SampleType>::channel(size_t index) const {
+        assert(index < m_numChannels);
+        return { m_data + index, numFrames(), m_numChannels };
+    }
+
+    template<typename SampleType>
+    std::span<const SampleType> MappedSampleBuffer<SampleType>::span() const noexcept {
+        return { m_data, m_size };
+    }
+
+    template<typename SampleType>
+    const SampleType* MappedSampleBuffer<SampleType>::begin() const noexcept {
+        return m_data;
+    }
+
+    template<typename SampleType>
+    const SampleType* MappedSampleBuffer<SampleType>::end() const noexcept {
+        return m_data + m_size;
+    }
+
+    template<typename SampleType>
+    bool MappedSampleBuffer<SampleType>::isMapped() const noexcept {
+        return m_mapping != nullptr;
+    }
+
+    template<typename SampleType>
+    void MappedSampleBuffer<SampleType>::advise(Access access) const {
+#if defined(DSP_HAS_MAPPED_FILES)
+        if(!m_mapping) return;
+
+        int advice = MADV_NORMAL;
+        switch(access){
+            case Access::Normal: advice = MADV_NORMAL; break;
+            case Access::Sequential: advice = MADV_SEQUENTIAL; break;
+            case Access::Random: advice = MADV_RANDOM; break;
+            case Access::WillNeed: advice = MADV_WILLNEED; break;
+        }
+        madvise(m_mapping, m_mappingSize, advice);
+#else
+        (void)access;
+#endif
+    }
+}
@@ -0,0 +1,305 @@
+#pragma once
+
+#include <new>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#define DSP_HAS_MIRRORED_MAPPING 1
+#endif
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#elif defined(__APPLE__)
+#include <cstdio>
+#include <atomic>
+#endif
+
+namespace dsp {
+
+    /**
+     * Power of two ring of samples whose storage is mapped twice back to back in virtual memory,
+     * so data()[i] and data()[i + capacity()] are the same sample. Any run of up to capacity()
+     * samples starting anywhere in the ring is contiguous, delay lines and FIR kernels can read
+     * latest(n) with plain vector loads and no wrap checks.
+     *
+     * The mapping needs page aligned sizes, so capacity is rounded up to a power of two that fills
+     * at least one page. Where it can't be mapped (Windows, or if mapping fails) the ring falls
+     * back to a plain 2 * capacity() allocation and write() and push() store every sample twice,
+     * reads behave the same either way.
+     */
+    template<typename SampleType>
+    class MirroredBuffer {
+    public:
+        static_assert(std::is_trivially_copyable_v<SampleType>, "SampleType should be trivially copyable");
+
+        explicit MirroredBuffer(size_t minCapacity);
+
+        ~MirroredBuffer();
+
+        MirroredBuffer(const MirroredBuffer&) = delete;
+
+        MirroredBuffer& operator=(const MirroredBuffer&) = delete;
+
+        MirroredBuffer(MirroredBuffer&& other) noexcept;
+
+        MirroredBuffer& operator=(MirroredBuffer&& other) noexcept;
+
+        void push(SampleType sample);
+
+        /**
+         * appends count samples, count <= capacity()
+         */
+        void write(const SampleType* samples, size_t count);
+
+        /**
+         * the newest count samples, oldest first, contiguous, count <= capacity()
+         */
+        [[nodiscard]]
+        const SampleType* latest(size_t count) const;
+
+        /**
+         * capacity() contiguous samples starting at index, wrapped into the ring
+         */
+        [[nodiscard]]
+        const SampleType* window(size_t index) const;
+
+        /**
+         * sample at index wrapped into the ring, negative indices count back from the end
+         */
+        const SampleType& operator[](std::ptrdiff_t index) const;
+
+        [[nodiscard]]
+        size_t capacity() const noexcept;
+
+        /**
+         * total number of samples written, the ring index of the next write is head() & (capacity() - 1)
+         */
+        [[nodiscard]]
+        size_t head() const noexcept;
+
+        /**
+         * true when the second half is a virtual memory mirror rather than a software copy
+         */
+        [[nodiscard]]
+        bool isMapped() const noexcept;
+
+        void clear();
+
+    private:
+        void allocate();
+
+        void release() noexcept;
+
+    private:
+        SampleType* m_data{nullptr};
+        size_t m_capacity{0};
+        size_t m_mask{0};
+        size_t m_head{0};
+        bool m_mapped{false};
+    };
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    namespace details {
+
+        inline size_t pageSize() {
+#if defined(DSP_HAS_MIRRORED_MAPPING)
+            return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+            return 4096;
+#endif
+        }
+
+#if defined(DSP_HAS_MIRRORED_MAPPING)
+        // file descriptor for bytes of anonymous shared memory, -1 on failure
+        inline int sharedMemory(size_t bytes) {
+#if defined(__linux__)
+            const auto fd = static_cast<int>(syscall(SYS_memfd_create, "dsp_mirrored_buffer", 0));
+#else
+            static std::atomic<unsigned> counter{0};
+            char name[64];
+            std::snprintf(name, sizeof(name), "/dsp_mirrored_%d_%u", static_cast<int>(getpid()), counter++);
+            const auto fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+            if(fd >= 0) shm_unlink(name);
+#endif
+            if(fd < 0) return -1;
+            if(ftruncate(fd, static_cast<off_t>(bytes)) != 0){
+                close(fd);
+                return -1;
+            }
+            return fd;
+        }
+
+        // maps the same bytes of shared memory twice back to back, nullptr on failure
+        inline void* mapMirrored(size_t bytes) {
+            const auto fd = sharedMemory(bytes);
+            if(fd < 0) return nullptr;
+
+            // reserve both halves first so nothing else can land in the second one
+            auto base = static_cast<char*>(mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if(base == MAP_FAILED){
+                close(fd);
+                return nullptr;
+            }
+
+            const auto first = mmap(base, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            const auto second = mmap(base + bytes, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0);
+            close(fd);
+
+            if(first == MAP_FAILED || second == MAP_FAILED){
+                munmap(base, 2 * bytes);
+                return nullptr;
+            }
+            return base;
+        }
+#endif
+    }
+
+    template<typename SampleType>
+    MirroredBuffer<SampleType>::MirroredBuffer(size_t minCapacity) {
+        const auto pageSamples = std::max<size_t>(1, details::pageSize() / sizeof(SampleType));
+        m_capacity = std::bit_ceil(std::max(minCapacity, pageSamples));
+        m_mask = m_capacity - 1;
+        allocate();
+    }
+
+    template<typename SampleType>
+    MirroredBuffer<SampleType>::~MirroredBuffer() {
+        release();
+    }
+
+    template<typename SampleType>
+    MirroredBuffer<SampleType>::MirroredBuffer(MirroredBuffer &&other) noexcept
+    : m_data{ std::exchange(other.m_data, nullptr) }
+    , m_capacity{ std::exchange(other.m_capacity, 0) }
+    , m_mask{ std::exchange(other.m_mask, 0) }
+    , m_head{ std::exchange(other.m_head, 0) }
+    , m_mapped{ std::exchange(other.m_mapped, false) }
+    {}
+
+    template<typename SampleType>
+    MirroredBuffer<SampleType>& MirroredBuffer<SampleType>::operator=(MirroredBuffer &&other) noexcept {
+        if(this != &other){
+            release();
+            m_data = std::exchange(other.m_data, nullptr);
+            m_capacity = std::exchange(other.m_capacity, 0);
+            m_mask = std::exchange(other.m_mask, 0);
+            m_head = std::exchange(other.m_head, 0);
+            m_mapped = std::exchange(other.m_mapped, false);
+        }
+        return *this;
+    }
+
+    template<typename SampleType>
+    void MirroredBuffer<SampleType>::allocate() {
+        const auto bytes = m_capacity * sizeof(SampleType);
+#if defined(DSP_HAS_MIRRORED_MAPPING)
+        if(auto memory = details::mapMirrored(bytes)){
+            m_data = static_cast<SampleType*>(memory);
+            m_mapped = true;
+            return;
+        }
+#endif
+        m_data = static_cast<SampleType*>(::operator new(2 * bytes, std::align_val_t{ 64 }));
+        std::memset(static_cast<void*>(m_data), 0, 2 * bytes);
+        m_mapped = false;
+    }
+
+    template<typename SampleType>
+    void MirroredBuffer<SampleType>::release() noexcept {
+        if(!m_data) return;
+
+        const auto bytes = m_capacity * sizeof(SampleType);
+#if defined(DSP_HAS_MIRRORED_MAPPING)
+        if(m_mapped){
+            munmap(m_data, 2 * bytes);
+            m_data = nullptr;
+            return;
+        }
+#endif
+        ::operator delete(m_data, 2 * bytes, std::align_val_t{ 64 });
+        m_data = nullptr;
+    }
+
+    template<typename SampleType>
+    void MirroredBuffer<SampleType>::push(SampleType sample) {
+        const auto index = m_head & m_mask;
+        m_data[index] = sample;
+        if(!m_mapped){
+            m_data[index + m_capacity] = sample;
+        }
+        m_head++;
+    }
+
+    template<typename SampleType>
+    void MirroredBuffer<SampleType>::write(const SampleType *samples, size_t count) {
+        assert(count <= m_capacity);
+
+        const auto index = m_head & m_mask;
+        if(m_mapped){
+            // a copy running past the first half lands in the mirror, which is the start of the ring
+            std::memcpy(m_data + index, samples, count * sizeof(SampleType));
+        }else {
+            const auto first = std::min(count, m_capacity - index);
+            std::memcpy(m_data + index, samples, first * sizeof(SampleType));
+            std::memcpy(m_data + index + m_capacity, samples, first * sizeof(SampleType));
+            std::memcpy(m_data, samples + first, (count - first) * sizeof(SampleType));
+            std::memcpy(m_data + m_capacity, samples + first, (count - first) * sizeof(SampleType));
+        }
+        m_head += count;
+    }
+
+    template<typename SampleType>
+    const SampleType* MirroredBuffer<SampleType>::latest(size_t count) const {
+        assert(count <= m_capacity);
+        return m_data + ((m_head - count) & m_mask);
+    }
+
+    template<typename SampleType>
+    const SampleType* MirroredBuffer<SampleType>::window(size_t index) const {
+        return m_data + (index & m_mask);
+    }
+
+    template<typename SampleType>
+    const SampleType& MirroredBuffer<SampleType>::operator[](std::ptrdiff_t index) const {
+        return m_data[static_cast<size_t>(index) & m_mask];
+    }
+
+    template<typename SampleType>
+    size_t MirroredBuffer<SampleType>::capacity() const noexcept {
+        return m_capacity;
+    }
+
+    template<typename SampleType>
+    size_t MirroredBuffer<SampleType>::head() const noexcept {
+        return m_head;
+    }
+
+    template<typename SampleType>
+    bool MirroredBuffer<SampleType>::isMapped() const noexcept {
+        return m_mapped;
+    }
+
+    template<typename SampleType>
+    void MirroredBuffer<SampleType>::clear() {
+        std::memset(static_cast<void*>(m_data), 0, (m_mapped ? 1 : 2) * m_capacity * sizeof(SampleType));
+        m_head = 0;
+    }
+}
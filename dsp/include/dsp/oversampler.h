@@ -0,0 +1,391 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include "dsp.h"
+#include "sample_buffer.h"
+
+namespace dsp {
+
+    /**
+     * Linear phase half-band low pass, cutoff at a quarter of the (higher) sample rate.
+     *
+     * A half-band kernel of length 4 * numTaps - 1 is zero at every even offset from its center
+     * apart from the center itself (0.5), so only the numTaps coefficients at odd offsets
+     * c[k] = h[center +- (2k + 1)] are stored, and shared by both sides of the symmetric kernel.
+     */
+    struct HalfBand {
+        std::vector<double> coefficients;
+
+        /**
+         * Kaiser windowed design, beta = 10 gives about 100dB stop band attenuation
+         */
+        static HalfBand design(size_t numTaps, double beta = 10);
+
+        [[nodiscard]]
+        size_t numTaps() const;
+
+        /**
+         * group delay of the kernel in samples at the higher rate
+         */
+        [[nodiscard]]
+        size_t delay() const;
+    };
+
+    /**
+     * Doubles the sample rate of a stream, polyphase so only the numTaps non zero odd taps
+     * are evaluated, the center tap phase is a plain delay
+     */
+    template<typename SampleType = float>
+    class HalfBandUpsampler {
+    public:
+        explicit HalfBandUpsampler(std::shared_ptr<const HalfBand> halfBand);
+
+        /**
+         * writes the two output samples for input to output[0] and output[1]
+         */
+        void process(SampleType input, SampleType* output);
+
+        void reset();
+
+    private:
+        std::shared_ptr<const HalfBand> m_halfBand;
+        std::vector<SampleType> m_coefficients;
+
+        // newest 2 * numTaps inputs, mirrored so they are always contiguous from m_head
+        std::vector<SampleType> m_history;
+        size_t m_head{0};
+    };
+
+    /**
+     * Halves the sample rate of a stream, band limiting it first with the half-band, the even
+     * input phase runs through the odd taps and the odd phase through the center tap only
+     */
+    template<typename SampleType = float>
+    class HalfBandDownsampler {
+    public:
+        explicit HalfBandDownsampler(std::shared_ptr<const HalfBand> halfBand);
+
+        /**
+         * consumes input[0] and input[1], returns one output sample
+         */
+        SampleType process(const SampleType* input);
+
+        void reset();
+
+    private:
+        std::shared_ptr<const HalfBand> m_halfBand;
+        std::vector<SampleType> m_coefficients;
+
+        // newest 2 * numTaps even phase inputs, mirrored
+        std::vector<SampleType> m_even;
+        size_t m_evenHead{0};
+
+        // newest numTaps odd phase inputs, mirrored, the oldest lines up with the center tap
+        std::vector<SampleType> m_odd;
+        size_t m_oddHead{0};
+    };
+
+    /**
+     * Runs a processor at 2x, 4x or 8x the sample rate through a cascade of half-band stages,
+     * so nonlinear stages (clipping, waveshaping, squaring) can add harmonics without them
+     * folding back into the audible band.
+     *
+     * The processor is either per sample, SampleType(SampleType), or per block,
+     * void(SampleType* samples, size_t count) working in place on the oversampled samples.
+     * Blocks are handed over in chunks of at most MaxBlockSize input samples, so processing
+     * never allocates.
+     */
+    template<typename SampleType = float>
+    class Oversampler {
+    public:
+        static constexpr size_t MaxBlockSize = 64;
+
+        /**
+         * @param factor 2, 4 or 8
+         * @param numTaps taps of the first stage, later stages run at higher rates with relatively
+         *        wider transition bands and use half as many taps as the stage before them
+         */
+        explicit Oversampler(size_t factor = 2, size_t numTaps = 16);
+
+        template<typename Processor>
+        SampleType process(SampleType input, Processor&& processor);
+
+        template<typename Processor>
+        void process(const SampleType* input, SampleType* output, size_t numSamples, Processor&& processor);
+
+        /**
+         * input and output may be strided, e.g. one channel of interleaved frames, and may be the same samples
+         */
+        template<typename Processor>
+        void process(SampleBufferView<const SampleType> input, SampleBufferView<SampleType> output, Processor&& processor);
+
+        template<typename Processor>
+        void process(SampleBufferView<SampleType> samples, Processor&& processor);
+
+        /**
+         * delay between input and output in samples at the base rate, may be fractional
+         */
+        [[nodiscard]]
+        double latency() const;
+
+        [[nodiscard]]
+        size_t factor() const;
+
+        void reset();
+
+    private:
+        // Input and Output are pointers or views, up to MaxBlockSize samples
+        template<typename Input, typename Output, typename Processor>
+        void processBlock(Input input, Output output, size_t numSamples, Processor& processor);
+
+    private:
+        size_t m_factor;
+        std::vector<HalfBandUpsampler<SampleType>> m_up;
+        std::vector<HalfBandDownsampler<SampleType>> m_down;
+        double m_latency{0};
+
+        std::vector<SampleType> m_buffer;
+        std::vector<SampleType> m_scratch;
+    };
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    inline HalfBand HalfBand::design(size_t numTaps, double beta) {
+        assert(numTaps > 0);
+
+        const auto M = 4 * numTaps - 2;
+        const auto center = 2 * numTaps - 1;
+
+        HalfBand halfBand{ std::vector<double>(numTaps) };
+        double sum{};
+        for(size_t k = 0; k < numTaps; k++){
+            const auto offset = static_cast<double>(2 * k + 1);
+            const auto sign = k % 2 == 0 ? 1.0 : -1.0;
+            const auto c = sign / (PI * offset) * Windows::kaiser(center + 2 * k + 1, M, beta);
+            halfBand.coefficients[k] = c;
+            sum += c;
+        }
+
+        // unity gain at DC, 0.5 + 2 * sum(c) == 1
+        for(auto& c : halfBand.coefficients){
+            c *= 0.25 / sum;
+        }
+        return halfBand;
+    }
+
+    inline size_t HalfBand::numTaps() const {
+        return coefficients.size();
+    }
+
+    inline size_t HalfBand::delay() const {
+        return 2 * numTaps() - 1;
+    }
+
+    template<typename SampleType>
+    HalfBandUpsampler<SampleType>::HalfBandUpsampler(std::shared_ptr<const HalfBand> halfBand)
+    : m_halfBand{ std::move(halfBand) }
+    , m_coefficients( m_halfBand->coefficients.begin(), m_halfBand->coefficients.end() )
+    , m_history( 4 * m_halfBand->numTaps() )
+    {}
+
+    template<typename SampleType>
+    void HalfBandUpsampler<SampleType>::process(SampleType input, SampleType *output) {
+        const auto T = m_coefficients.size();
+        const auto L = 2 * T;
+
+        m_head = m_head == 0 ? L - 1 : m_head - 1;
+        m_history[m_head] = m_history[m_head + L] = input;
+
+        // X[j] = x[n - j]
+        const auto X = m_history.data() + m_head;
+        const auto C = m_coefficients.data();
+
+        SampleType sum{};
+        for(size_t k = 0; k < T; k++){
+            sum += C[k] * (X[T - 1 - k] + X[T + k]);
+        }
+        output[0] = 2 * sum;
+        output[1] = X[T - 1];
+    }
+
+    template<typename SampleType>
+    void HalfBandUpsampler<SampleType>::reset() {
+        std::fill(m_history.begin(), m_history.end(), SampleType{});
+        m_head = 0;
+    }
+
+    template<typename SampleType>
+    HalfBandDownsampler<SampleType>::HalfBandDownsampler(std::shared_ptr<const HalfBand> halfBand)
+    : m_halfBand{ std::move(halfBand) }
+    , m_coefficients( m_halfBand->coefficients.begin(), m_halfBand->coefficients.end() )
+    , m_even( 4 * m_halfBand->numTaps() )
+    , m_odd( 2 * m_halfBand->numTaps() )
+    {}
+
+    template<typename SampleType>
+    SampleType HalfBandDownsampler<SampleType>::process(const SampleType *input) {
+        const auto T = m_coefficients.size();
+        const auto L = 2 * T;
+
+        // input[0] is v[2n - 1], input[1] is v[2n]
+        m_oddHead = m_oddHead == 0 ? T - 1 : m_oddHead - 1;
+        m_odd[m_oddHead] = m_odd[m_oddHead + T] = input[0];
+        const auto centre = m_odd[m_oddHead + T - 1];
+
+        m_evenHead = m_evenHead == 0 ? L - 1 : m_evenHead - 1;
+        m_even[m_evenHead] = m_even[m_evenHead + L] = input[1];
+
+        // E[j] = v[2(n - j)]
+        const auto E = m_even.data() + m_evenHead;
+        const auto C = m_coefficients.data();
+
+        SampleType sum{};
+        for(size_t k = 0; k < T; k++){
+            sum += C[k] * (E[T - 1 - k] + E[T + k]);
+        }
+        return sum + SampleType(0.5) * centre;
+    }
+
+    template<typename SampleType>
+    void HalfBandDownsampler<SampleType>::reset() {
+        std::fill(m_even.begin(), m_even.end(), SampleType{});
+        std::fill(m_odd.begin(), m_odd.end(), SampleType{});
+        m_evenHead = 0;
+        m_oddHead = 0;
+    }
+
+    template<typename SampleType>
+    Oversampler<SampleType>::Oversampler(size_t factor, size_t numTaps)
+    : m_factor{ factor }
+    , m_buffer( MaxBlockSize * factor )
+    , m_scratch( MaxBlockSize * factor )
+    {
+        assert(factor == 2 || factor == 4 || factor == 8);
+
+        auto taps = numTaps;
+        double rate = 1;
+        for(size_t stage = 1; stage < factor; stage *= 2){
+            const auto halfBand = std::make_shared<const HalfBand>(HalfBand::design(taps));
+            m_up.emplace_back(halfBand);
+            m_down.emplace_back(halfBand);
+
+            // each stage delays by its kernel's group delay at its rate going up and again coming down,
+            // less one sample as the downsampler pairs the upsampler's outputs from the odd phase
+            rate *= 2;
+            m_latency += (2.0 * static_cast<double>(halfBand->delay()) - 1) / rate;
+            taps = std::max<size_t>(2, taps / 2);
+        }
+    }
+
+    template<typename SampleType>
+    template<typename Processor>
+    SampleType Oversampler<SampleType>::process(SampleType input, Processor &&processor) {
+        SampleType output;
+        process(&input, &output, 1, processor);
+        return output;
+    }
+
+    template<typename SampleType>
+    template<typename Processor>
+    void Oversampler<SampleType>::process(const SampleType *input, SampleType *output, size_t numSamples, Processor &&processor) {
+        for(size_t offset = 0; offset < numSamples; offset += MaxBlockSize){
+            const auto N = std::min(MaxBlockSize, numSamples - offset);
+            processBlock(input + offset, output + offset, N, processor);
+        }
+    }
+
+    template<typename SampleType>
+    template<typename Processor>
+    void Oversampler<SampleType>::process(SampleBufferView<const SampleType> input, SampleBufferView<SampleType> output, Processor &&processor) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            process(input.data(), output.data(), input.size(), processor);
+            return;
+        }
+        for(size_t offset = 0; offset < input.size(); offset += MaxBlockSize){
+            const auto N = std::min(MaxBlockSize, input.size() - offset);
+            processBlock(input.subview(offset, N), output.subview(offset, N), N, processor);
+        }
+    }
+
+    template<typename SampleType>
+    template<typename Processor>
+    void Oversampler<SampleType>::process(SampleBufferView<SampleType> samples, Processor &&processor) {
+        process(SampleBufferView<const SampleType>{ samples }, samples, processor);
+    }
+
+    template<typename SampleType>
+    template<typename Input, typename Output, typename Processor>
+    void Oversampler<SampleType>::processBlock(Input input, Output output, size_t numSamples, Processor &processor) {
+        const auto stages = m_up.size();
+
+        // up: each stage doubles the block, ping ponging between m_buffer and m_scratch so the
+        // last stage lands in m_buffer. The whole input is read before any output is written,
+        // so input and output may be the same samples
+        auto first = stages % 2 == 1 ? m_buffer.data() : m_scratch.data();
+        for(size_t i = 0; i < numSamples; i++){
+            m_up[0].process(input[i], first + 2 * i);
+        }
+
+        const SampleType* src = first;
+        auto count = 2 * numSamples;
+        for(size_t s = 1; s < stages; s++){
+            auto dst = (stages - s) % 2 == 1 ? m_buffer.data() : m_scratch.data();
+            for(size_t i = 0; i < count; i++){
+                m_up[s].process(src[i], dst + 2 * i);
+            }
+            src = dst;
+            count *= 2;
+        }
+
+        const auto samples = m_buffer.data();
+        if constexpr (std::is_invocable_v<Processor&, SampleType*, size_t>){
+            processor(samples, count);
+        }else {
+            for(size_t i = 0; i < count; i++){
+                samples[i] = static_cast<SampleType>(processor(samples[i]));
+            }
+        }
+
+        // down, in place, the last stage writes to output
+        for(size_t s = stages; s > 1; s--){
+            for(size_t i = 0; i < count / 2; i++){
+                samples[i] = m_down[s - 1].process(samples + 2 * i);
+            }
+            count /= 2;
+        }
+        for(size_t i = 0; i < numSamples; i++){
+            output[i] = m_down[0].process(samples + 2 * i);
+        }
+    }
+
+    template<typename SampleType>
+    double Oversampler<SampleType>::latency() const {
+        return m_latency;
+    }
+
+    template<typename SampleType>
+    size_t Oversampler<SampleType>::factor() const {
+        return m_factor;
+    }
+
+    template<typename SampleType>
+    void Oversampler<SampleType>::reset() {
+        for(auto& up : m_up) up.reset();
+        for(auto& down : m_down) down.reset();
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace dsp {
+
+    /**
+     * Splits [0, count) into one contiguous range per thread and calls
+     * task(begin, end) for each, the calling thread takes the first range.
+     */
+    template<typename Task>
+    void parallelFor(size_t count, Task&& task, unsigned numThreads = std::thread::hardware_concurrency()) {
+        const auto N = std::max<size_t>(1, std::min<size_t>(numThreads, count));
+        const auto chunk = (count + N - 1) / N;
+
+        std::vector<std::thread> threads;
+        threads.reserve(N - 1);
+        for(size_t t = 1; t < N; t++){
+            const auto begin = t * chunk;
+            const auto end = std::min(count, begin + chunk);
+            if(begin >= end) break;
+            threads.emplace_back([&task, begin, end]{ task(begin, end); });
+        }
+
+        task(size_t{0}, std::min(count, chunk));
+
+        for(auto& thread : threads){
+            thread.join();
+        }
+    }
+}
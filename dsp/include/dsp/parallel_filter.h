@@ -0,0 +1,208 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+#include <thread>
+#include <cassert>
+#include <type_traits>
+#include "coefficients.h"
+#include "parallel.h"
+
+namespace dsp {
+
+    /**
+     * Filters a long signal from rest, splitting it into blocks that are filtered on separate threads.
+     *
+     * The recursion r[n] = sum(a[k] * x[n - k]) + sum(b[k] * r[n - k]) is linear in its output history,
+     * so each block is first filtered as if the preceding outputs were zero. The true output history
+     * is then carried from block to block with a precomputed Poles x Poles matrix (a sequential scan
+     * costing Poles^2 per block), and finally each block adds the decaying response of its carried
+     * history. The result matches Coefficients::process up to floating point rounding.
+     *
+     * input and output must not overlap.
+     */
+    template<size_t Poles, typename Real, typename SampleType>
+    void parallelFilter(const Coefficients<Poles, Real>& filter, const SampleType* input, SampleType* output, size_t numSamples
+                        , size_t blockSize = 4096, unsigned numThreads = std::thread::hardware_concurrency());
+
+    template<size_t Poles, typename Real, typename SampleType>
+    void parallelFilter(const Coefficients<Poles, Real>& filter, std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output
+                        , size_t blockSize = 4096, unsigned numThreads = std::thread::hardware_concurrency());
+
+    /**
+     * input and output may be strided, e.g. one channel of interleaved frames, but must not overlap
+     */
+    template<size_t Poles, typename Real, typename SampleType>
+    void parallelFilter(const Coefficients<Poles, Real>& filter, SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output
+                        , size_t blockSize = 4096, unsigned numThreads = std::thread::hardware_concurrency());
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    namespace details {
+
+        // recursion output k samples before the last processed sample
+        template<size_t Poles, typename Real>
+        double previousOutput(const Coefficients<Poles, Real>& filter, size_t k) {
+            return filter.y[filter.head + k];
+        }
+
+        template<typename Real>
+        double previousOutput(const Coefficients<2, Real>& filter, size_t k) {
+            return filter.y[k + 1];
+        }
+
+        // runs r[n] = sum(b[k] * r[n - k]) from history (newest first), calling sink(n, r[n]) for every sample
+        template<size_t Poles, typename Real, typename Sink>
+        void homogeneousResponse(const std::array<Real, Poles + 1u>& b, std::array<double, Poles> history, size_t numSamples, Sink&& sink) {
+            for(size_t n = 0; n < numSamples; n++){
+                double r{};
+                for(size_t k = 0; k < Poles; k++){
+                    r += b[k + 1] * history[k];
+                }
+                for(size_t k = Poles - 1; k > 0; --k){
+                    history[k] = history[k - 1];
+                }
+                history[0] = r;
+                sink(n, r);
+            }
+        }
+
+        // numSamples samples from offset on, for plain pointers and strided views alike
+        template<typename T>
+        T* samplesFrom(T* samples, size_t offset, size_t) {
+            return samples + offset;
+        }
+
+        template<typename T>
+        SampleBufferView<T> samplesFrom(SampleBufferView<T> samples, size_t offset, size_t numSamples) {
+            return samples.subview(offset, numSamples);
+        }
+
+        template<size_t Poles, typename Real, typename T>
+        void filterBlock(Coefficients<Poles, Real>& filter, const T* input, T* output, size_t numSamples) {
+            filter.process(input, output, numSamples);
+        }
+
+        template<size_t Poles, typename Real, typename T>
+        void filterBlock(Coefficients<Poles, Real>& filter, SampleBufferView<const T> input, SampleBufferView<T> output, size_t) {
+            filter.template process<T>(input, output);
+        }
+
+        // shared by the pointer and view overloads, Input and Output are pointers or SampleBufferViews
+        template<size_t Poles, typename Real, typename Input, typename Output>
+        void parallelFilter(const Coefficients<Poles, Real>& filter, Input input, Output output, size_t numSamples
+                            , size_t blockSize, unsigned numThreads);
+    }
+
+    template<size_t Poles, typename Real, typename SampleType>
+    void parallelFilter(const Coefficients<Poles, Real>& filter, const SampleType* input, SampleType* output, size_t numSamples
+                        , size_t blockSize, unsigned numThreads) {
+        assert(input + numSamples <= output || output + numSamples <= input);
+        details::parallelFilter(filter, input, output, numSamples, blockSize, numThreads);
+    }
+
+    template<size_t Poles, typename Real, typename SampleType>
+    void parallelFilter(const Coefficients<Poles, Real>& filter, SampleBufferView<const std::type_identity_t<SampleType>> input, SampleBufferView<SampleType> output
+                        , size_t blockSize, unsigned numThreads) {
+        assert(output.size() >= input.size());
+        if(input.contiguous() && output.contiguous()){
+            parallelFilter(filter, input.data(), output.data(), input.size(), blockSize, numThreads);
+        }else {
+            details::parallelFilter(filter, input, output, input.size(), blockSize, numThreads);
+        }
+    }
+
+    template<size_t Poles, typename Real, typename Input, typename Output>
+    void details::parallelFilter(const Coefficients<Poles, Real>& filter, Input input, Output output, size_t numSamples
+                                 , size_t blockSize, unsigned numThreads) {
+        assert(blockSize >= Poles);
+        using SampleType = std::remove_cvref_t<decltype(output[0])>;
+        using History = std::array<double, Poles>;
+
+        if(numSamples == 0) return;
+
+        const auto L = blockSize;
+        const auto numBlocks = (numSamples + L - 1) / L;
+
+        // column j holds the last Poles outputs of a block that starts from the unit history e_j
+        std::array<History, Poles> M{};
+        for(size_t j = 0; j < Poles; j++){
+            History unit{};
+            unit[j] = 1;
+            details::homogeneousResponse<Poles>(filter.b, unit, L, [&](size_t n, double r){
+                if(n + Poles >= L){
+                    M[j][L - 1 - n] = r;
+                }
+            });
+        }
+
+        // 1. zero state response of every block, the raw recursion output goes to output
+        std::vector<History> tails(numBlocks);
+        parallelFor(numBlocks, [&](size_t first, size_t last){
+            for(size_t block = first; block < last; block++){
+                const auto start = block * L;
+                const auto N = std::min(L, numSamples - start);
+
+                auto blockFilter = filter;
+                blockFilter.c0 = 1;
+                blockFilter.d0 = 0;
+                blockFilter.reset();
+                for(size_t k = Poles; k > 0; --k){
+                    blockFilter(start >= k ? static_cast<double>(input[start - k]) : 0.0);
+                }
+                blockFilter.y.fill(0);
+
+                details::filterBlock(blockFilter, details::samplesFrom(input, start, N), details::samplesFrom(output, start, N), N);
+
+                for(size_t k = 0; k < Poles; k++){
+                    tails[block][k] = details::previousOutput(blockFilter, k);
+                }
+            }
+        }, numThreads);
+
+        // 2. carry the true output history across blocks
+        std::vector<History> histories(numBlocks);
+        for(size_t block = 1; block < numBlocks; block++){
+            const auto& previous = histories[block - 1];
+            auto& history = histories[block];
+            history = tails[block - 1];
+            for(size_t j = 0; j < Poles; j++){
+                for(size_t i = 0; i < Poles; i++){
+                    history[i] += M[j][i] * previous[j];
+                }
+            }
+        }
+
+        // 3. add each block's response to its carried history and apply the output mix
+        const auto c0 = filter.c0;
+        const auto d0 = filter.d0;
+        parallelFor(numBlocks, [&](size_t first, size_t last){
+            for(size_t block = first; block < last; block++){
+                const auto start = block * L;
+                const auto N = std::min(L, numSamples - start);
+                auto X = details::samplesFrom(input, start, N);
+                auto Y = details::samplesFrom(output, start, N);
+
+                details::homogeneousResponse<Poles>(filter.b, histories[block], N, [&](size_t n, double r){
+                    Y[n] = static_cast<SampleType>((Y[n] + r) * c0 + X[n] * d0);
+                });
+            }
+        }, numThreads);
+    }
+
+    template<size_t Poles, typename Real, typename SampleType>
+    void parallelFilter(const Coefficients<Poles, Real>& filter, std::span<const std::type_identity_t<SampleType>> input, std::span<SampleType> output
+                        , size_t blockSize, unsigned numThreads) {
+        assert(output.size() >= input.size());
+        parallelFilter(filter, input.data(), output.data(), input.size(), blockSize, numThreads);
+    }
+}
@@ -5,6 +5,8 @@
 #include <deque>
 #include <tuple>
 #include "coefficients.h"
+#include "cascade.h"
+#include "constexpr_math.h"
 
 namespace dsp::recursive {
 
@@ -13,16 +15,19 @@ namespace dsp::recursive {
     struct chebyshev {
 
         template<size_t Poles>
-        static Coefficients<Poles> computeCoefficients(FilterType filter, double passBandRipple, double cutoffFrequency);
+        static constexpr Coefficients<Poles> computeCoefficients(FilterType filter, double passBandRipple, double cutoffFrequency);
+
+        template<size_t Poles>
+        static constexpr Cascade<Poles / 2> computeSections(FilterType filter, double passBandRipple, double cutoffFrequency);
 
     private:
-        static Poles computePoles(FilterType filter, double passBandRipple, int numPoles, int pole, double cutoffFrequency);
+        static constexpr Poles computePoles(FilterType filter, double passBandRipple, int numPoles, int pole, double cutoffFrequency);
 
     };
 
 
     template<size_t Poles>
-    Coefficients<Poles>
+    constexpr Coefficients<Poles>
     chebyshev::computeCoefficients(FilterType filter, double passBandRipple, double cutoffFrequency) {
         assert(cutoffFrequency >= 0.0 && cutoffFrequency <= 0.5);
         assert(passBandRipple >= 0.0 && passBandRipple <= 29.0);
@@ -36,10 +41,10 @@ namespace dsp::recursive {
         constexpr auto NP = Poles;
 
 
-        std::vector<double> A(22);
-        std::vector<double> B(22);
-        std::vector<double> TA(22);
-        std::vector<double> TB(22);
+        std::array<double, 22> A{};
+        std::array<double, 22> B{};
+        std::array<double, 22> TA{};
+        std::array<double, 22> TB{};
 
         A[2] = 1;
         B[2] = 1;
@@ -74,8 +79,9 @@ namespace dsp::recursive {
             }
         }else {
             for(int i = 0; i < 20; i++){
-                sumA += A[i] * std::pow(-1, i);
-                sumB += B[i] * std::pow(-1, i);
+                const auto sign = i % 2 == 0 ? 1.0 : -1.0;
+                sumA += A[i] * sign;
+                sumB += B[i] * sign;
             }
         }
 
@@ -85,9 +91,6 @@ namespace dsp::recursive {
             A[i] /= gain;
         }
 
-        std::vector<double> outA(NP + 1);
-        std::vector<double> outB(NP + 1);
-
         Coefficients<NP> coefficients{};
 
         auto first = A.begin();
@@ -104,23 +107,51 @@ namespace dsp::recursive {
 
     }
 
-    Poles chebyshev::computePoles(FilterType filter, double passBandRipple, int numPoles, int pole, double cutoffFrequency){
+    template<size_t Poles>
+    constexpr Cascade<Poles / 2>
+    chebyshev::computeSections(FilterType filter, double passBandRipple, double cutoffFrequency) {
+        assert(cutoffFrequency >= 0.0 && cutoffFrequency <= 0.5);
+        assert(passBandRipple >= 0.0 && passBandRipple <= 29.0);
+        assert(filter == FilterType::LowPass || filter == FilterType::HighPass);
+        static_assert(Poles % 2 == 0);
+        static_assert(Poles >= 2 && Poles <= 20);
+
+        Cascade<Poles / 2> cascade{};
+
+        for(auto P = 1; P <= Poles/2; P++){
+            auto [A0, A1, A2, B1, B2] = computePoles(filter, passBandRipple, Poles, P, cutoffFrequency);
+
+            // normalize each section to unity gain at DC (low pass) or nyquist (high pass)
+            auto gain = filter == FilterType::LowPass
+                    ? (A0 + A1 + A2) / (1 - B1 - B2)
+                    : (A0 - A1 + A2) / (1 + B1 - B2);
+
+            auto& section = cascade.sections[P - 1];
+            section.a = { A0/gain, A1/gain, A2/gain };
+            section.b = { 0, B1, B2 };
+        }
+
+        return cascade;
+    }
+
+    constexpr Poles chebyshev::computePoles(FilterType filter, double passBandRipple, int numPoles, int pole, double cutoffFrequency){
         const double x = PI/(numPoles * 2) + (pole - 1) * PI/numPoles;
-        double rPole = -std::cos(x);
-        double iPole = std::sin(x);
+        double rPole = -math::cos(x);
+        double iPole = math::sin(x);
 
         // Warp from a circle to an ellipse
         if(passBandRipple != 0){
-            auto ES = std::sqrt(std::pow((100.0 / (100.0 - passBandRipple)), 2) - 1);
-            auto VX = (1.0 / numPoles) * std::log((1.0 / ES) + sqrt(1.0 / (ES * ES) + 1));
-            auto KX = (1.0 / numPoles) * std::log((1.0 / ES) + sqrt(1.0 / (ES * ES) - 1));
-            KX = (std::exp(KX) + std::exp(-KX)) * 0.5;
-            rPole *= ((std::exp(VX) - std::exp(-VX)) / 2) / KX;
-            iPole *= ((std::exp(VX) + std::exp(-VX)) / 2) / KX;
+            const auto ratio = 100.0 / (100.0 - passBandRipple);
+            auto ES = math::sqrt(ratio * ratio - 1);
+            auto VX = (1.0 / numPoles) * math::log((1.0 / ES) + math::sqrt(1.0 / (ES * ES) + 1));
+            auto KX = (1.0 / numPoles) * math::log((1.0 / ES) + math::sqrt(1.0 / (ES * ES) - 1));
+            KX = (math::exp(KX) + math::exp(-KX)) * 0.5;
+            rPole *= ((math::exp(VX) - math::exp(-VX)) / 2) / KX;
+            iPole *= ((math::exp(VX) + math::exp(-VX)) / 2) / KX;
         }
 
         // s-domain to z-domain conversion
-        auto T = 2.0 * std::tan(0.5);
+        auto T = 2.0 * math::tan(0.5);
         auto W = 2.0 * PI * cutoffFrequency;
         auto M = rPole * rPole + iPole * iPole;
         auto D = 4.0 - 4.0 * rPole * T + M * T * T;
@@ -132,8 +163,8 @@ namespace dsp::recursive {
 
 
         auto K = filter == FilterType::HighPass ?
-                 -std::cos(W * 0.5 + 0.5)/std::cos(W * 0.5 - 0.5)
-                                                : std::sin(-W * 0.5 + 0.5)/std::sin(W * 0.5 + 0.5);
+                 -math::cos(W * 0.5 + 0.5)/math::cos(W * 0.5 - 0.5)
+                                                : math::sin(-W * 0.5 + 0.5)/math::sin(W * 0.5 + 0.5);
 
         D = 1.0 + Y1 * K - Y2 * K * K;
         auto A0 = (X0 - X1 * K + X2 * K * K)/D;
@@ -150,23 +181,36 @@ namespace dsp::recursive {
         return std::make_tuple(A0, A1, A2, B1, B2);
     }
 
-    template<size_t Poles = 4>
-    auto lowPassFilter(double cutoffFrequency){
+    template<size_t Poles = 4, typename Real = double>
+    constexpr auto lowPassFilter(double cutoffFrequency){
+        assert(cutoffFrequency >= 0 && cutoffFrequency <= 0.5);
+        return chebyshev::computeCoefficients<Poles>(FilterType::LowPass, 0.5, cutoffFrequency).template cast<Real>();
+    }
+
+    template<size_t Poles = 4, typename Real = double>
+    constexpr auto highPassFilter(double cutoffFrequency){
+        assert(cutoffFrequency >= 0 && cutoffFrequency <= 0.5);
+        return chebyshev::computeCoefficients<Poles>(FilterType::HighPass, 0.5, cutoffFrequency).template cast<Real>();
+    }
+
+    template<size_t Poles = 4, typename Real = double>
+    constexpr auto lowPassCascade(double cutoffFrequency){
         assert(cutoffFrequency >= 0 && cutoffFrequency <= 0.5);
-        return chebyshev::computeCoefficients<Poles>(FilterType::LowPass, 0.5, cutoffFrequency);
+        return chebyshev::computeSections<Poles>(FilterType::LowPass, 0.5, cutoffFrequency).template cast<Real>();
     }
 
-    template<size_t Poles = 4>
-    auto highPassFilter(double cutoffFrequency){
+    template<size_t Poles = 4, typename Real = double>
+    constexpr auto highPassCascade(double cutoffFrequency){
         assert(cutoffFrequency >= 0 && cutoffFrequency <= 0.5);
-        return chebyshev::computeCoefficients<Poles>(FilterType::HighPass, 0.5, cutoffFrequency);
+        return chebyshev::computeSections<Poles>(FilterType::HighPass, 0.5, cutoffFrequency).template cast<Real>();
     }
 
-    auto bandPassFilter(double centerFrequency, double bandwidth){
+    template<typename Real = double>
+    constexpr auto bandPassFilter(double centerFrequency, double bandwidth){
         const auto cf = centerFrequency;
         const auto BW = bandwidth;
         const auto R = 1 - 3 * BW;
-        const auto cos2pif = std::cos(2 * PI * cf);
+        const auto cos2pif = math::cos(2 * PI * cf);
         const auto K = (1 - 2 * R * cos2pif + R * R) / (2 - 2 * cos2pif);
 
         BiQuad biQuad{
@@ -182,14 +226,15 @@ namespace dsp::recursive {
             }
         };
 
-        return biQuad;
+        return biQuad.template cast<Real>();
     }
 
-    auto bandRejectFilter(double centerFrequency, double bandwidth){
+    template<typename Real = double>
+    constexpr auto bandRejectFilter(double centerFrequency, double bandwidth){
         const auto cf = centerFrequency;
         const auto BW = bandwidth;
         const auto R = 1 - 3 * BW;
-        const auto cos2pif = std::cos(2 * PI * cf);
+        const auto cos2pif = math::cos(2 * PI * cf);
         const auto K = (1 - 2 * R * cos2pif + R * R) / (2 - 2 * cos2pif);
 
         BiQuad biQuad{
@@ -205,16 +250,17 @@ namespace dsp::recursive {
             }
         };
 
-        return biQuad;
+        return biQuad.template cast<Real>();
     }
 
-    auto lowShelf(double frequency, double gain){
-        auto u = std::pow(10.0f, gain / 20);
+    template<typename Real = double>
+    constexpr auto lowShelf(double frequency, double gain){
+        auto u = math::pow(10.0, gain / 20);
         auto w = frequency;
         auto v = 4.0 / (1 + u);
-        auto x = v * std::tan(w / 2);
+        auto x = v * math::tan(w / 2);
         auto y = (1 - x) / (1 + x);
-        BiQuad bq;
+        BiQuad bq{};
         bq.a[0] = (1 - y)/2;
         bq.a[1] = bq.a[0];
         bq.a[2] = 0;
@@ -223,14 +269,15 @@ namespace dsp::recursive {
         bq.c0 = u - 1;
         bq.d0 = 1.0f;
 
-        return bq;
+        return bq.template cast<Real>();
     }
 
-    auto highShelf(double frequency, double gain){
-        auto u = std::pow(10, gain / 20);
+    template<typename Real = double>
+    constexpr auto highShelf(double frequency, double gain){
+        auto u = math::pow(10, gain / 20);
         auto w = frequency;
         auto v = (1 + u) / 4;
-        auto x = v * std::tan(w / 2);
+        auto x = v * math::tan(w / 2);
         auto y = (1 - x) / (1 + x);
         BiQuad bq{};
         bq.a[0] = (1 + y)/2;
@@ -239,17 +286,18 @@ namespace dsp::recursive {
         bq.c0 = u - 1;
         bq.d0 = 1;
 
-        return bq;
+        return bq.template cast<Real>();
     }
 
-    auto peakingFilter(double frequency, double gain, double q){
-        auto u = std::pow(10, gain / 20);
+    template<typename Real = double>
+    constexpr auto peakingFilter(double frequency, double gain, double q){
+        auto u = math::pow(10, gain / 20);
         auto v = 4 / (1 + u);
         auto w = frequency;
-        auto x = std::tan(w / (2 * q));
+        auto x = math::tan(w / (2 * q));
         auto vx = v * x;
         auto y = .5 * ((1 - vx) / (1 + vx));
-        auto z = (.5 + y) * std::cos(w);
+        auto z = (.5 + y) * math::cos(w);
 
         BiQuad bq{};
         bq.a[0] = .5 - y;
@@ -259,6 +307,6 @@ namespace dsp::recursive {
         bq.c0 = u - 1;
         bq.d0 = 1;
 
-        return bq;
+        return bq.template cast<Real>();
     }
 }
\ No newline at end of file
@@ -3,40 +3,179 @@
 #include <cstddef>
 #include <array>
 #include <atomic>
+#include <utility>
 #include <optional>
+#include <algorithm>
+#include "allocator.h"
 
 namespace dsp {
 
+    /**
+     * Lock free queue between exactly one producer thread and one consumer thread.
+     *
+     * push and push_n may only be called by the producer, poll, pop and pop_n only by the
+     * consumer. A full queue rejects new entries instead of overwriting old ones, and an empty queue
+     * yields nothing. All Capacity slots are usable.
+     *
+     * The indices count up freely and are masked into the ring, so Capacity must be a power of two.
+     * Each side owns a cache line holding its own index and a cached copy of the other side's index.
+     * The other side's index is only reloaded when the cached copy says the queue is full (producer)
+     * or empty (consumer), so most operations touch no shared cache line beyond the slot itself.
+     */
     template<typename Entry, size_t Capacity>
     class RingBuffer {
     public:
+        static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity should be a power of two");
+
         RingBuffer() = default;
 
-        void push(Entry entry) {
-            m_data[++m_writeIndex % Capacity] = entry;
+        RingBuffer(const RingBuffer&) = delete;
+
+        RingBuffer& operator=(const RingBuffer&) = delete;
+
+        /**
+         * false if the queue is full, entry is then dropped
+         */
+        bool push(Entry entry);
+
+        /**
+         * pushes as many of count entries as fit, returns how many were pushed
+         */
+        size_t push_n(const Entry* entries, size_t count);
+
+        /**
+         * the next entry, empty if there is none
+         */
+        std::optional<Entry> poll();
+
+        /**
+         * moves the next entry into entry, false if there is none
+         */
+        bool pop(Entry& entry);
+
+        /**
+         * pops up to count entries into entries, returns how many were popped
+         */
+        size_t pop_n(Entry* entries, size_t count);
+
+        /**
+         * number of queued entries, exact from either side when the other side is idle, a snapshot
+         * otherwise
+         */
+        [[nodiscard]]
+        size_t size() const;
+
+        [[nodiscard]]
+        bool empty() const;
+
+        [[nodiscard]]
+        bool full() const;
+
+        static constexpr size_t capacity() { return Capacity; }
+
+    private:
+        static constexpr size_t Mask = Capacity - 1;
+
+        // producer's line
+        alignas(CacheLineSize) std::atomic<size_t> m_writeIndex{0};
+        size_t m_cachedReadIndex{0};
+
+        // consumer's line
+        alignas(CacheLineSize) std::atomic<size_t> m_readIndex{0};
+        size_t m_cachedWriteIndex{0};
+
+        alignas(CacheLineSize) std::array<Entry, Capacity> m_data{};
+    };
+
+    template<typename Entry, size_t Capacity>
+    bool RingBuffer<Entry, Capacity>::push(Entry entry) {
+        const auto write = m_writeIndex.load(std::memory_order_relaxed);
+        if(write - m_cachedReadIndex == Capacity){
+            m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
+            if(write - m_cachedReadIndex == Capacity) return false;
+        }
+
+        m_data[write & Mask] = std::move(entry);
+        m_writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Entry, size_t Capacity>
+    size_t RingBuffer<Entry, Capacity>::push_n(const Entry *entries, size_t count) {
+        const auto write = m_writeIndex.load(std::memory_order_relaxed);
+        if(Capacity - (write - m_cachedReadIndex) < count){
+            m_cachedReadIndex = m_readIndex.load(std::memory_order_acquire);
         }
 
-        bool size() const {
-            return (m_writeIndex - m_readIndex) + 1;
+        const auto n = std::min(count, Capacity - (write - m_cachedReadIndex));
+        if(n == 0) return 0;
+
+        // at most two runs, up to the end of the ring and then from its start
+        const auto first = std::min(n, Capacity - (write & Mask));
+        std::copy(entries, entries + first, m_data.begin() + (write & Mask));
+        std::copy(entries + first, entries + n, m_data.begin());
+
+        m_writeIndex.store(write + n, std::memory_order_release);
+        return n;
+    }
+
+    template<typename Entry, size_t Capacity>
+    std::optional<Entry> RingBuffer<Entry, Capacity>::poll() {
+        std::optional<Entry> entry{ std::in_place };
+        if(!pop(*entry)){
+            return {};
         }
+        return entry;
+    }
 
-        bool empty() const {
-            return m_writeIndex < m_readIndex;
+    template<typename Entry, size_t Capacity>
+    bool RingBuffer<Entry, Capacity>::pop(Entry &entry) {
+        const auto read = m_readIndex.load(std::memory_order_relaxed);
+        if(read == m_cachedWriteIndex){
+            m_cachedWriteIndex = m_writeIndex.load(std::memory_order_acquire);
+            if(read == m_cachedWriteIndex) return false;
         }
 
-        std::optional<Entry> poll() {
-            if(empty()){
-                return {};
-            }
-            auto value = m_data[m_readIndex % Capacity];
-            m_readIndex++;
-            return value;
+        entry = std::move(m_data[read & Mask]);
+        m_readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    template<typename Entry, size_t Capacity>
+    size_t RingBuffer<Entry, Capacity>::pop_n(Entry *entries, size_t count) {
+        const auto read = m_readIndex.load(std::memory_order_relaxed);
+        if(m_cachedWriteIndex - read < count){
+            m_cachedWriteIndex = m_writeIndex.load(std::memory_order_acquire);
         }
 
-    private:
-        std::array<Entry, Capacity> m_data;
-        std::atomic_int m_writeIndex{-1};
-        std::atomic_int m_readIndex{0};
-    };
+        const auto n = std::min(count, m_cachedWriteIndex - read);
+        if(n == 0) return 0;
+
+        const auto first = std::min(n, Capacity - (read & Mask));
+        const auto start = m_data.begin() + (read & Mask);
+        std::move(start, start + first, entries);
+        std::move(m_data.begin(), m_data.begin() + (n - first), entries + first);
+
+        m_readIndex.store(read + n, std::memory_order_release);
+        return n;
+    }
+
+    template<typename Entry, size_t Capacity>
+    size_t RingBuffer<Entry, Capacity>::size() const {
+        // read first, the write index can only have moved further since
+        const auto read = m_readIndex.load(std::memory_order_acquire);
+        const auto write = m_writeIndex.load(std::memory_order_acquire);
+        return std::min(write - read, Capacity);
+    }
+
+    template<typename Entry, size_t Capacity>
+    bool RingBuffer<Entry, Capacity>::empty() const {
+        return size() == 0;
+    }
+
+    template<typename Entry, size_t Capacity>
+    bool RingBuffer<Entry, Capacity>::full() const {
+        return size() == Capacity;
+    }
 
-}
\ No newline at end of file
+}
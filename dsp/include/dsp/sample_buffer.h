@@ -1,85 +1,200 @@
 #pragma once
 
+#include <span>
 #include <vector>
+#include <compare>
 #include <type_traits>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <utility>
 #include <cstddef>
 #include <cassert>
 #include <cmath>
+#include "allocator.h"
+#include "sample_expression.h"
 
 namespace dsp {
 
     template<typename SampleType>
     class SampleBufferView;
 
-    template<typename SampleType, bool Circular = false, size_t Capacity = 0>
+    /**
+     * Padding::Simd rounds the storage up to a whole number of SimdWidth samples and keeps the
+     * tail past size() zeroed, so vector kernels can run over paddedSize() without a scalar tail
+     */
+    enum class Padding { None, Simd };
+
+    /**
+     * Owns a signal, storage comes from Allocator, which aligns it to a cache line by default.
+     * pmr::SampleBuffer takes its memory from a std::pmr::memory_resource such as pmr::threadArena()
+     */
+    template<typename SampleType, bool Circular = false, size_t Capacity = 0, typename Allocator = AlignedAllocator<SampleType>>
     class SampleBuffer {
     public:
-        friend class SampleBufferView<SampleType>;
+        using allocator_type = Allocator;
 
-        SampleBuffer() {
+        static constexpr size_t SimdWidth = CacheLineSize / sizeof(SampleType);
+
+        static_assert(!Circular || (Capacity > 0 && (Capacity & (Capacity - 1)) == 0), "Capacity of a circular buffer should be a power of two");
+
+        // circular indices wrap with a mask, negative ones count back from the end
+        static constexpr size_t Mask = Circular ? Capacity - 1 : 0;
+
+        SampleBuffer()
+                :SampleBuffer(Allocator())
+        {}
+
+        explicit SampleBuffer(const Allocator& allocator)
+                : m_data(allocator)
+        {
             static_assert(std::is_floating_point_v<SampleType>, "SampleType should be floating point type");
             if constexpr (Circular){
-                if(m_data.empty() || m_data.size() < Capacity){
-                    m_data.resize(Capacity);
-                }
+                m_data.resize(Capacity);
+                m_size = Capacity;
             }
         }
 
-        SampleBuffer(const SampleBuffer<SampleType, Circular>& other)
-                :SampleBuffer(other.m_data.begin(), other.m_data.end())
+        SampleBuffer(const SampleBuffer& other)
+                :SampleBuffer(other, std::allocator_traits<Allocator>::select_on_container_copy_construction(other.m_data.get_allocator()))
+        {}
+
+        SampleBuffer(const SampleBuffer& other, const Allocator& allocator)
+                :SampleBuffer(allocator)
+        {
+            m_padding = other.m_padding;
+            m_data.assign(other.m_data.begin(), other.m_data.end());
+            m_size = other.m_size;
+        }
+
+        SampleBuffer(SampleBuffer&& other) noexcept
+                : m_data(std::move(other.m_data))
+                , m_size{ std::exchange(other.m_size, 0) }
+                , m_padding{ other.m_padding }
         {}
 
-        template<typename SampleIterator>
-        SampleBuffer(SampleIterator first, SampleIterator last)
-                :SampleBuffer()
+        /**
+         * evaluates the expression in a single pass
+         */
+        template<Expression Expr>
+        SampleBuffer(const Expr& expression, const Allocator& allocator = Allocator())
+                :SampleBuffer(allocator)
         {
-            m_data = std::vector<SampleType>(first, last);
+            assign(expression);
         }
 
-        SampleBuffer(size_t size, SampleType val)
-                :SampleBuffer()
+        template<std::input_iterator SampleIterator>
+        SampleBuffer(SampleIterator first, SampleIterator last, const Allocator& allocator = Allocator())
+                :SampleBuffer(allocator)
         {
-            m_data = std::vector<SampleType>(size, val);
+            m_data.assign(first, last);
+            m_size = m_data.size();
         }
 
-        explicit SampleBuffer(size_t size)
-                :SampleBuffer()
+        SampleBuffer(size_t size, SampleType val, const Allocator& allocator = Allocator())
+                :SampleBuffer(allocator)
         {
-            m_data = std::vector<SampleType>(size);
+            m_data.assign(size, val);
+            m_size = size;
+        }
+
+        explicit SampleBuffer(size_t size, const Allocator& allocator = Allocator())
+                :SampleBuffer(size, Padding::None, allocator)
+        {}
+
+        SampleBuffer(size_t size, Padding padding, const Allocator& allocator = Allocator())
+                :SampleBuffer(allocator)
+        {
+            assert(!Circular || padding == Padding::None);
+            m_padding = padding;
+            resize(size);
+        }
+
+        SampleBuffer& operator=(const SampleBuffer& other) {
+            if(this != &other){
+                m_padding = other.m_padding;
+                m_data.assign(other.m_data.begin(), other.m_data.end());
+                m_size = other.m_size;
+            }
+            return *this;
+        }
+
+        SampleBuffer& operator=(SampleBuffer&& other) noexcept(std::allocator_traits<Allocator>::is_always_equal::value) {
+            if(this != &other){
+                m_data = std::move(other.m_data);
+                m_size = std::exchange(other.m_size, 0);
+                m_padding = other.m_padding;
+                other.m_data.clear();
+            }
+            return *this;
+        }
+
+        template<Expression Expr>
+        SampleBuffer& operator=(const Expr& expression) {
+            assign(expression);
+            return *this;
+        }
+
+        template<typename Other> requires Operand<Other> || Scalar<Other>
+        SampleBuffer& operator+=(const Other& other) {
+            return *this = *this + other;
+        }
+
+        template<typename Other> requires Operand<Other> || Scalar<Other>
+        SampleBuffer& operator-=(const Other& other) {
+            return *this = *this - other;
+        }
+
+        template<typename Other> requires Operand<Other> || Scalar<Other>
+        SampleBuffer& operator*=(const Other& other) {
+            return *this = *this * other;
         }
 
         template<typename = std::enable_if<!Circular>>
         void add(SampleType sample){
-            m_data.push_back(sample);
+            if(m_size == m_data.size()){
+                resize(m_size + 1);
+            }else {
+                m_size++;
+            }
+            m_data[m_size - 1] = sample;
         }
 
         template<typename SampleTypeB, bool CircularB, typename = std::enable_if<std::is_same_v<SampleType, SampleTypeB>>, typename = std::enable_if<!Circular>>
         void add(const SampleBuffer<SampleTypeB, CircularB>& buffer) {
-            auto offset = m_data.size();
-            m_data.resize(m_data.size() + buffer.size());
-            std::memcpy(m_data.data() + offset, buffer.m_data.data(), buffer.size());
+            auto offset = m_size;
+            resize(m_size + buffer.size());
+            std::memcpy(m_data.data() + offset, buffer.data(), buffer.size() * sizeof(SampleType));
         }
 
         auto size() const noexcept {
+            return m_size;
+        }
+
+        /**
+         * samples that may be read or written by vector kernels, size() rounded up to SimdWidth
+         * when padded
+         */
+        auto paddedSize() const noexcept {
             return m_data.size();
         }
 
+        Padding padding() const noexcept {
+            return m_padding;
+        }
+
         const SampleType& operator[](const int idx) const {
-            auto index = idx;
             if constexpr (Circular){
-                const auto size = m_data.size();
-                index = (size + index)%size;
+                return m_data[static_cast<size_t>(idx) & Mask];
             }
-            return m_data[index];
+            return m_data[idx];
         }
 
         SampleType& operator[](const int idx) {
-            auto index = idx;
             if constexpr (Circular){
-                const auto size = m_data.size();
-                index = (size + index)%size;
+                return m_data[static_cast<size_t>(idx) & Mask];
             }
-            return m_data[index];
+            return m_data[idx];
         }
 
         explicit operator SampleType*() noexcept {
@@ -92,10 +207,18 @@ namespace dsp {
 
         void clear() noexcept {
             m_data.clear();
+            m_size = 0;
         }
 
-        void resize(size_t size) noexcept {
-            m_data.resize(size);
+        void resize(size_t size) {
+            const auto padded = m_padding == Padding::Simd ? (size + SimdWidth - 1) / SimdWidth * SimdWidth : size;
+            if(padded > m_data.size()){
+                m_data.resize(padded);
+            }else {
+                m_data.resize(padded);
+                std::fill(m_data.begin() + static_cast<std::ptrdiff_t>(size), m_data.end(), SampleType{});
+            }
+            m_size = size;
         }
 
         auto begin() noexcept {
@@ -103,7 +226,7 @@ namespace dsp {
         }
 
         auto end() noexcept {
-            return m_data.end();
+            return m_data.begin() + static_cast<std::ptrdiff_t>(m_size);
         }
 
         auto cbegin() const noexcept {
@@ -111,65 +234,302 @@ namespace dsp {
         }
 
         auto cend() const noexcept {
-            return m_data.cend();
+            return m_data.cbegin() + static_cast<std::ptrdiff_t>(m_size);
         }
 
         SampleType* data() noexcept {
             return m_data.data();
         }
 
-        SampleType* data() const noexcept {
+        const SampleType* data() const noexcept {
             return m_data.data();
         }
 
+        allocator_type get_allocator() const noexcept {
+            return m_data.get_allocator();
+        }
+
         operator bool() const {
-            return !m_data.empty();
+            return m_size != 0;
         }
 
-        SampleBufferView<SampleType> view(size_t start, size_t size);
+        /**
+         * count samples starting at offset, every stride'th one, without copying. count defaults to
+         * the rest of the buffer, so view(channel, frames, channels) is one channel of interleaved data
+         */
+        SampleBufferView<SampleType> view(size_t offset = 0, size_t count = npos, size_t stride = 1);
+
+        SampleBufferView<const SampleType> view(size_t offset = 0, size_t count = npos, size_t stride = 1) const;
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    private:
+        template<typename Expr>
+        void assign(const Expr& expression) {
+            static_assert(!Expr::broadcast, "a constant alone has no size to assign");
+            const auto N = expression.size();
+            assert(!Circular || N == m_size);
+            if(N != m_size){
+                resize(N);
+            }
+            auto output = m_data.data();
+            for(size_t i = 0; i < N; i++){
+                output[i] = static_cast<SampleType>(expression[i]);
+            }
+        }
 
     private:
-        std::vector<SampleType> m_data;
+        std::vector<SampleType, Allocator> m_data;
+        size_t m_size{0};
+        Padding m_padding{Padding::None};
     };
 
+    /**
+     * Non owning view of samples spaced stride apart, over a SampleBuffer, a span or any raw or
+     * interleaved memory. SampleBufferView<const T> is read only, SampleBufferView<T> writes through
+     * to the viewed samples and converts to SampleBufferView<const T>.
+     */
     template<typename SampleType>
-    class SampleBufferView{
+    class SampleBufferView {
     public:
-        SampleBufferView(SampleType* first, SampleType* last)
-                : m_first(first)
-                , m_last(last)
-        {}
+        using value_type = std::remove_const_t<SampleType>;
+        using element_type = SampleType;
 
-        auto size() const noexcept {
-            return std::distance(m_first, m_last);
-        }
+        class iterator {
+        public:
+            using iterator_concept = std::random_access_iterator_tag;
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = std::remove_const_t<SampleType>;
+            using difference_type = std::ptrdiff_t;
+            using pointer = SampleType*;
+            using reference = SampleType&;
 
-        const SampleType& operator[](const int idx) const {
-            return m_first[idx];
-        }
+            iterator() = default;
 
-        explicit operator SampleType*() const noexcept {
-            return m_first;
-        }
+            iterator(SampleType* sample, std::ptrdiff_t stride) : m_sample{ sample }, m_stride{ stride } {}
 
-        auto cbegin() const noexcept {
-            return m_first;
-        }
+            reference operator*() const { return *m_sample; }
+            pointer operator->() const { return m_sample; }
+            reference operator[](difference_type n) const { return m_sample[n * m_stride]; }
 
-        auto cend() const noexcept {
-            return m_last;
-        }
+            iterator& operator++() { m_sample += m_stride; return *this; }
+            iterator operator++(int) { auto copy = *this; ++*this; return copy; }
+            iterator& operator--() { m_sample -= m_stride; return *this; }
+            iterator operator--(int) { auto copy = *this; --*this; return copy; }
+            iterator& operator+=(difference_type n) { m_sample += n * m_stride; return *this; }
+            iterator& operator-=(difference_type n) { m_sample -= n * m_stride; return *this; }
+
+            friend iterator operator+(iterator it, difference_type n) { return it += n; }
+            friend iterator operator+(difference_type n, iterator it) { return it += n; }
+            friend iterator operator-(iterator it, difference_type n) { return it -= n; }
+            friend difference_type operator-(const iterator& a, const iterator& b) { return (a.m_sample - b.m_sample) / a.m_stride; }
+
+            friend bool operator==(const iterator& a, const iterator& b) { return a.m_sample == b.m_sample; }
+            friend auto operator<=>(const iterator& a, const iterator& b) { return (a.m_sample - b.m_sample) * a.m_stride <=> 0; }
+
+        private:
+            SampleType* m_sample{nullptr};
+            std::ptrdiff_t m_stride{1};
+        };
+
+        SampleBufferView() = default;
+
+        SampleBufferView(SampleType* data, size_t size, size_t stride = 1);
+
+        SampleBufferView(SampleType* first, SampleType* last);
+
+        SampleBufferView(std::span<SampleType> samples);
+
+        template<bool Circular, size_t Capacity, typename Allocator>
+        SampleBufferView(SampleBuffer<value_type, Circular, Capacity, Allocator>& buffer) requires (!std::is_const_v<SampleType>);
+
+        template<bool Circular, size_t Capacity, typename Allocator>
+        SampleBufferView(const SampleBuffer<value_type, Circular, Capacity, Allocator>& buffer) requires std::is_const_v<SampleType>;
+
+        template<typename Other>
+        SampleBufferView(const SampleBufferView<Other>& other) requires std::is_same_v<const Other, SampleType> && (!std::is_same_v<Other, SampleType>);
+
+        [[nodiscard]]
+        size_t size() const noexcept;
+
+        [[nodiscard]]
+        size_t stride() const noexcept;
+
+        [[nodiscard]]
+        bool empty() const noexcept;
+
+        /**
+         * true when the samples are adjacent, so data() can be used as a plain array
+         */
+        [[nodiscard]]
+        bool contiguous() const noexcept;
+
+        [[nodiscard]]
+        SampleType* data() const noexcept;
+
+        SampleType& operator[](size_t idx) const;
+
+        explicit operator SampleType*() const noexcept;
+
+        /**
+         * count samples starting at offset, every step'th one, offset and count are in samples of this view
+         */
+        [[nodiscard]]
+        SampleBufferView subview(size_t offset, size_t count, size_t step = 1) const;
+
+        /**
+         * the samples as a span, only for contiguous views
+         */
+        [[nodiscard]]
+        std::span<SampleType> span() const;
+
+        iterator begin() const noexcept;
+
+        iterator end() const noexcept;
+
+        iterator cbegin() const noexcept;
+
+        iterator cend() const noexcept;
 
     private:
-        const SampleType* m_first;
-        const SampleType* m_last;
+        SampleType* m_data{nullptr};
+        size_t m_size{0};
+        size_t m_stride{1};
     };
 
-    template<typename SampleType, bool Circular, size_t Capacity>
-    SampleBufferView<SampleType> SampleBuffer<SampleType, Circular, Capacity>::view(size_t start, size_t size) {
-        assert(start >= 0 && start < m_data.size());
-        assert(size > start && size <= m_data.size());
-        return SampleBuffer<SampleType, Circular>(m_data.data() + start, m_data.data() + size);
+    template<typename SampleType>
+    SampleBufferView<SampleType>::SampleBufferView(SampleType *data, size_t size, size_t stride)
+            : m_data{ data }
+            , m_size{ size }
+            , m_stride{ stride }
+    {
+        assert(stride > 0);
+    }
+
+    template<typename SampleType>
+    SampleBufferView<SampleType>::SampleBufferView(SampleType *first, SampleType *last)
+            : SampleBufferView(first, static_cast<size_t>(std::distance(first, last)))
+    {}
+
+    template<typename SampleType>
+    SampleBufferView<SampleType>::SampleBufferView(std::span<SampleType> samples)
+            : SampleBufferView(samples.data(), samples.size())
+    {}
+
+    template<typename SampleType>
+    template<bool Circular, size_t Capacity, typename Allocator>
+    SampleBufferView<SampleType>::SampleBufferView(SampleBuffer<value_type, Circular, Capacity, Allocator> &buffer) requires (!std::is_const_v<SampleType>)
+            : SampleBufferView(buffer.data(), buffer.size())
+    {}
+
+    template<typename SampleType>
+    template<bool Circular, size_t Capacity, typename Allocator>
+    SampleBufferView<SampleType>::SampleBufferView(const SampleBuffer<value_type, Circular, Capacity, Allocator> &buffer) requires std::is_const_v<SampleType>
+            : SampleBufferView(buffer.data(), buffer.size())
+    {}
+
+    template<typename SampleType>
+    template<typename Other>
+    SampleBufferView<SampleType>::SampleBufferView(const SampleBufferView<Other> &other) requires std::is_same_v<const Other, SampleType> && (!std::is_same_v<Other, SampleType>)
+            : SampleBufferView(other.data(), other.size(), other.stride())
+    {}
+
+    template<typename SampleType>
+    size_t SampleBufferView<SampleType>::size() const noexcept {
+        return m_size;
+    }
+
+    template<typename SampleType>
+    size_t SampleBufferView<SampleType>::stride() const noexcept {
+        return m_stride;
+    }
+
+    template<typename SampleType>
+    bool SampleBufferView<SampleType>::empty() const noexcept {
+        return m_size == 0;
+    }
+
+    template<typename SampleType>
+    bool SampleBufferView<SampleType>::contiguous() const noexcept {
+        return m_stride == 1;
+    }
+
+    template<typename SampleType>
+    SampleType* SampleBufferView<SampleType>::data() const noexcept {
+        return m_data;
+    }
+
+    template<typename SampleType>
+    SampleType& SampleBufferView<SampleType>::operator[](size_t idx) const {
+        return m_data[idx * m_stride];
+    }
+
+    template<typename SampleType>
+    SampleBufferView<SampleType>::operator SampleType*() const noexcept {
+        return m_data;
+    }
+
+    template<typename SampleType>
+    SampleBufferView<SampleType> SampleBufferView<SampleType>::subview(size_t offset, size_t count, size_t step) const {
+        assert(step > 0);
+        assert(offset + (count == 0 ? 0 : (count - 1) * step) < std::max<size_t>(m_size, 1) || count == 0);
+        return SampleBufferView{ m_data + offset * m_stride, count, m_stride * step };
+    }
+
+    template<typename SampleType>
+    std::span<SampleType> SampleBufferView<SampleType>::span() const {
+        assert(contiguous());
+        return std::span<SampleType>{ m_data, m_size };
+    }
+
+    template<typename SampleType>
+    typename SampleBufferView<SampleType>::iterator SampleBufferView<SampleType>::begin() const noexcept {
+        return iterator{ m_data, static_cast<std::ptrdiff_t>(m_stride) };
+    }
+
+    template<typename SampleType>
+    typename SampleBufferView<SampleType>::iterator SampleBufferView<SampleType>::end() const noexcept {
+        return iterator{ m_data + m_size * m_stride, static_cast<std::ptrdiff_t>(m_stride) };
+    }
+
+    template<typename SampleType>
+    typename SampleBufferView<SampleType>::iterator SampleBufferView<SampleType>::cbegin() const noexcept {
+        return begin();
+    }
+
+    template<typename SampleType>
+    typename SampleBufferView<SampleType>::iterator SampleBufferView<SampleType>::cend() const noexcept {
+        return end();
+    }
+
+    template<typename SampleType>
+    SampleBufferView(SampleType*, size_t, size_t) -> SampleBufferView<SampleType>;
+
+    template<typename SampleType>
+    SampleBufferView(std::span<SampleType>) -> SampleBufferView<SampleType>;
+
+    template<typename SampleType, bool Circular, size_t Capacity, typename Allocator>
+    SampleBufferView(SampleBuffer<SampleType, Circular, Capacity, Allocator>&) -> SampleBufferView<SampleType>;
+
+    template<typename SampleType, bool Circular, size_t Capacity, typename Allocator>
+    SampleBufferView(const SampleBuffer<SampleType, Circular, Capacity, Allocator>&) -> SampleBufferView<const SampleType>;
+
+    template<typename SampleType, bool Circular, size_t Capacity, typename Allocator>
+    SampleBufferView<SampleType> SampleBuffer<SampleType, Circular, Capacity, Allocator>::view(size_t offset, size_t count, size_t stride) {
+        assert(stride > 0 && offset <= m_size);
+        const auto available = m_size == offset ? 0 : (m_size - offset - 1) / stride + 1;
+        const auto N = count == npos ? available : count;
+        assert(N <= available);
+        return SampleBufferView<SampleType>{ data() + offset, N, stride };
+    }
+
+    template<typename SampleType, bool Circular, size_t Capacity, typename Allocator>
+    SampleBufferView<const SampleType> SampleBuffer<SampleType, Circular, Capacity, Allocator>::view(size_t offset, size_t count, size_t stride) const {
+        assert(stride > 0 && offset <= m_size);
+        const auto available = m_size == offset ? 0 : (m_size - offset - 1) / stride + 1;
+        const auto N = count == npos ? available : count;
+        assert(N <= available);
+        return SampleBufferView<const SampleType>{ data() + offset, N, stride };
     }
 
     template<typename SampleType, size_t Capacity>
@@ -178,6 +538,12 @@ namespace dsp {
     template<typename SampleType, bool Circular = false>
     using Signal = SampleBuffer<SampleType, Circular>;
 
-    template<typename SampleType, bool Circular>
+    template<typename SampleType, bool Circular = false>
     using Kernel = SampleBuffer<SampleType, Circular>;
+
+    namespace pmr {
+
+        template<typename SampleType>
+        using SampleBuffer = dsp::SampleBuffer<SampleType, false, 0, AlignedAllocator<SampleType>>;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+
+namespace dsp {
+
+    template<typename SampleType, bool Circular, size_t Capacity, typename Allocator>
+    class SampleBuffer;
+
+    /**
+     * Arithmetic on SampleBuffers builds an expression instead of a buffer, nothing is computed
+     * until the expression is assigned to a SampleBuffer, which then evaluates every operation
+     * for a sample in one loop. out = (a + b) * g reads a and b once, writes out once and needs
+     * no temporaries.
+     *
+     * Expressions hold references to the buffers in them, so they should be assigned before those
+     * buffers change size or go away. Every operation is element wise, so a buffer may appear
+     * on both sides of an assignment as long as its size doesn't change.
+     *
+     * Buffers combined in one expression must have the same size, an empty buffer included, only
+     * constants (broadcast expressions) combine with any size. Mismatches assert, without asserts
+     * the expression is evaluated over the shortest buffer so nothing is read past its end.
+     */
+    struct SampleExpression {};
+
+    template<typename T>
+    struct IsSampleBuffer : std::false_type {};
+
+    template<typename SampleType, bool Circular, size_t Capacity, typename Allocator>
+    struct IsSampleBuffer<SampleBuffer<SampleType, Circular, Capacity, Allocator>> : std::true_type {};
+
+    template<typename T>
+    concept Expression = std::is_base_of_v<SampleExpression, std::remove_cvref_t<T>>;
+
+    // anything arithmetic can be applied to, a buffer or an expression
+    template<typename T>
+    concept Operand = Expression<T> || IsSampleBuffer<std::remove_cvref_t<T>>::value;
+
+    template<typename T>
+    concept Scalar = std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+    template<typename SampleType>
+    struct TerminalExpression : SampleExpression {
+        using value_type = SampleType;
+
+        static constexpr bool broadcast = false;
+
+        const SampleType* data;
+        size_t count;
+
+        SampleType operator[](size_t i) const { return data[i]; }
+
+        [[nodiscard]]
+        size_t size() const { return count; }
+    };
+
+    // a constant broadcast to every sample, it takes the size of the operand it combines with
+    template<typename SampleType>
+    struct ScalarExpression : SampleExpression {
+        using value_type = SampleType;
+
+        static constexpr bool broadcast = true;
+
+        SampleType value;
+
+        SampleType operator[](size_t) const { return value; }
+
+        [[nodiscard]]
+        size_t size() const { return 0; }
+    };
+
+    template<typename Op, typename Lhs, typename Rhs>
+    struct BinaryExpression : SampleExpression {
+        using value_type = std::common_type_t<typename Lhs::value_type, typename Rhs::value_type>;
+
+        static constexpr bool broadcast = Lhs::broadcast && Rhs::broadcast;
+
+        Lhs lhs;
+        Rhs rhs;
+
+        value_type operator[](size_t i) const { return Op::apply(lhs[i], rhs[i]); }
+
+        [[nodiscard]]
+        size_t size() const {
+            if constexpr (Lhs::broadcast){
+                return rhs.size();
+            }else if constexpr (Rhs::broadcast){
+                return lhs.size();
+            }else {
+                return std::min(lhs.size(), rhs.size());
+            }
+        }
+    };
+
+    template<typename Op, typename Inner>
+    struct UnaryExpression : SampleExpression {
+        using value_type = typename Inner::value_type;
+
+        static constexpr bool broadcast = Inner::broadcast;
+
+        Inner operand;
+        Op op;
+
+        value_type operator[](size_t i) const { return op(operand[i]); }
+
+        [[nodiscard]]
+        size_t size() const { return operand.size(); }
+    };
+
+    template<Operand Lhs, Operand Rhs>
+    auto operator+(const Lhs& lhs, const Rhs& rhs);
+
+    template<Operand Lhs, Operand Rhs>
+    auto operator-(const Lhs& lhs, const Rhs& rhs);
+
+    template<Operand Lhs, Operand Rhs>
+    auto operator*(const Lhs& lhs, const Rhs& rhs);
+
+    template<Operand Lhs, Scalar Rhs>
+    auto operator+(const Lhs& lhs, Rhs rhs);
+
+    template<Scalar Lhs, Operand Rhs>
+    auto operator+(Lhs lhs, const Rhs& rhs);
+
+    template<Operand Lhs, Scalar Rhs>
+    auto operator-(const Lhs& lhs, Rhs rhs);
+
+    template<Scalar Lhs, Operand Rhs>
+    auto operator-(Lhs lhs, const Rhs& rhs);
+
+    /**
+     * gain
+     */
+    template<Operand Lhs, Scalar Rhs>
+    auto operator*(const Lhs& lhs, Rhs rhs);
+
+    template<Scalar Lhs, Operand Rhs>
+    auto operator*(Lhs lhs, const Rhs& rhs);
+
+    template<Operand Rhs>
+    auto operator-(const Rhs& rhs);
+
+    /**
+     * every sample limited to [lower, upper]
+     */
+    template<Operand Samples, Scalar Bound>
+    auto clamp(const Samples& samples, Bound lower, Bound upper);
+
+    /**
+     * a * (1 - t) + b * t, t is a constant or a per sample expression
+     */
+    template<Operand A, Operand B, typename T> requires Scalar<T> || Operand<T>
+    auto mix(const A& a, const B& b, const T& t);
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    namespace details {
+
+        struct Add {
+            template<typename A, typename B>
+            static auto apply(A a, B b) { return a + b; }
+        };
+
+        struct Subtract {
+            template<typename A, typename B>
+            static auto apply(A a, B b) { return a - b; }
+        };
+
+        struct Multiply {
+            template<typename A, typename B>
+            static auto apply(A a, B b) { return a * b; }
+        };
+
+        template<typename SampleType>
+        struct Clamp {
+            SampleType lower;
+            SampleType upper;
+
+            SampleType operator()(SampleType sample) const { return std::clamp(sample, lower, upper); }
+        };
+
+        struct Negate {
+            template<typename A>
+            A operator()(A a) const { return -a; }
+        };
+
+        // buffers are captured by pointer, expressions by value as they are small and may be temporaries
+        template<Operand T>
+        auto terminal(const T& operand) {
+            if constexpr (Expression<T>){
+                return operand;
+            }else {
+                using SampleType = std::remove_cv_t<std::remove_pointer_t<decltype(operand.data())>>;
+                return TerminalExpression<SampleType>{ {}, operand.data(), operand.size() };
+            }
+        }
+
+        template<Operand T>
+        using sample_type_of = typename decltype(terminal(std::declval<const T&>()))::value_type;
+
+        // constants take the sample type of the operand they combine with, so a float buffer times
+        // a double stays float
+        template<Operand T, Scalar S>
+        auto scalar(S value) {
+            return ScalarExpression<sample_type_of<T>>{ {}, static_cast<sample_type_of<T>>(value) };
+        }
+
+        template<typename Op, typename Lhs, typename Rhs>
+        auto binary(Lhs lhs, Rhs rhs) {
+            if constexpr (!Lhs::broadcast && !Rhs::broadcast){
+                assert(lhs.size() == rhs.size() && "buffers in an expression must have the same size");
+            }
+            return BinaryExpression<Op, Lhs, Rhs>{ {}, std::move(lhs), std::move(rhs) };
+        }
+    }
+
+    template<Operand Lhs, Operand Rhs>
+    auto operator+(const Lhs& lhs, const Rhs& rhs) {
+        return details::binary<details::Add>(details::terminal(lhs), details::terminal(rhs));
+    }
+
+    template<Operand Lhs, Operand Rhs>
+    auto operator-(const Lhs& lhs, const Rhs& rhs) {
+        return details::binary<details::Subtract>(details::terminal(lhs), details::terminal(rhs));
+    }
+
+    template<Operand Lhs, Operand Rhs>
+    auto operator*(const Lhs& lhs, const Rhs& rhs) {
+        return details::binary<details::Multiply>(details::terminal(lhs), details::terminal(rhs));
+    }
+
+    template<Operand Lhs, Scalar Rhs>
+    auto operator+(const Lhs& lhs, Rhs rhs) {
+        return details::binary<details::Add>(details::terminal(lhs), details::scalar<Lhs>(rhs));
+    }
+
+    template<Scalar Lhs, Operand Rhs>
+    auto operator+(Lhs lhs, const Rhs& rhs) {
+        return details::binary<details::Add>(details::scalar<Rhs>(lhs), details::terminal(rhs));
+    }
+
+    template<Operand Lhs, Scalar Rhs>
+    auto operator-(const Lhs& lhs, Rhs rhs) {
+        return details::binary<details::Subtract>(details::terminal(lhs), details::scalar<Lhs>(rhs));
+    }
+
+    template<Scalar Lhs, Operand Rhs>
+    auto operator-(Lhs lhs, const Rhs& rhs) {
+        return details::binary<details::Subtract>(details::scalar<Rhs>(lhs), details::terminal(rhs));
+    }
+
+    template<Operand Lhs, Scalar Rhs>
+    auto operator*(const Lhs& lhs, Rhs rhs) {
+        return details::binary<details::Multiply>(details::terminal(lhs), details::scalar<Lhs>(rhs));
+    }
+
+    template<Scalar Lhs, Operand Rhs>
+    auto operator*(Lhs lhs, const Rhs& rhs) {
+        return details::binary<details::Multiply>(details::scalar<Rhs>(lhs), details::terminal(rhs));
+    }
+
+    template<Operand Rhs>
+    auto operator-(const Rhs& rhs) {
+        using Terminal = decltype(details::terminal(rhs));
+        return UnaryExpression<details::Negate, Terminal>{ {}, details::terminal(rhs), {} };
+    }
+
+    template<Operand Samples, Scalar Bound>
+    auto clamp(const Samples& samples, Bound lower, Bound upper) {
+        using SampleType = details::sample_type_of<Samples>;
+        using Terminal = decltype(details::terminal(samples));
+        const details::Clamp<SampleType> op{ static_cast<SampleType>(lower), static_cast<SampleType>(upper) };
+        return UnaryExpression<details::Clamp<SampleType>, Terminal>{ {}, details::terminal(samples), op };
+    }
+
+    template<Operand A, Operand B, typename T> requires Scalar<T> || Operand<T>
+    auto mix(const A& a, const B& b, const T& t) {
+        return a + (b - a) * t;
+    }
+}
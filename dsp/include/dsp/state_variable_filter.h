@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cassert>
+#include <algorithm>
+#include "constants.h"
+#include "denormal.h"
+
+namespace dsp {
+
+    /**
+     * Topology preserving transform state variable filter, stays stable and free of
+     * zipper noise while its frequency and resonance are modulated.
+     *
+     * set() takes a new target and the coefficients ramp linearly towards it over
+     * rampLength samples, so targets only need updating at a control rate. The first
+     * set() on a filter without a target jumps straight to it. Per sample cost is that of
+     * a static biquad, plus one division while a ramp is running.
+     */
+    class StateVariableFilter {
+    public:
+        struct Outputs {
+            double lowPass;
+            double bandPass;
+            double highPass;
+        };
+
+        StateVariableFilter() = default;
+
+        StateVariableFilter(double frequency, double q, size_t rampLength = 32);
+
+        /**
+         * no target yet, the first set() takes effect immediately
+         */
+        explicit StateVariableFilter(size_t rampLength);
+
+        /**
+         * @param frequency fraction of the sample rate in [0, 0.5)
+         * @param q resonance, for a band pass the center frequency over the bandwidth
+         */
+        void set(double frequency, double q);
+
+        void rampLength(size_t length);
+
+        template<typename SampleType>
+        Outputs tick(SampleType iSample);
+
+        template<typename SampleType>
+        SampleType lowPass(SampleType iSample);
+
+        /**
+         * band pass normalized to unity gain at the center frequency
+         */
+        template<typename SampleType>
+        SampleType bandPass(SampleType iSample);
+
+        template<typename SampleType>
+        SampleType highPass(SampleType iSample);
+
+        void reset();
+
+    private:
+        void updateCoefficients();
+
+    private:
+        double m_g{0};
+        double m_k{1};
+        double m_targetG{0};
+        double m_targetK{1};
+        double m_dg{0};
+        double m_dk{0};
+        size_t m_remaining{0};
+        size_t m_rampLength{32};
+        bool m_initialized{false};
+
+        // derived from m_g and m_k, refreshed only when they change
+        double m_a1{1};
+        double m_a2{0};
+        double m_a3{0};
+
+        double m_ic1eq{0};
+        double m_ic2eq{0};
+    };
+
+    inline StateVariableFilter::StateVariableFilter(double frequency, double q, size_t rampLength)
+    : m_rampLength{ std::max<size_t>(1, rampLength) }
+    {
+        set(frequency, q);
+    }
+
+    inline StateVariableFilter::StateVariableFilter(size_t rampLength)
+    : m_rampLength{ std::max<size_t>(1, rampLength) }
+    {}
+
+    inline void StateVariableFilter::set(double frequency, double q) {
+        assert(frequency >= 0 && frequency < 0.5);
+        assert(q > 0);
+
+        m_targetG = std::tan(PI * frequency);
+        m_targetK = 1.0 / q;
+
+        if(!m_initialized){
+            m_initialized = true;
+            m_g = m_targetG;
+            m_k = m_targetK;
+            m_remaining = 0;
+            updateCoefficients();
+            return;
+        }
+
+        m_dg = (m_targetG - m_g) / static_cast<double>(m_rampLength);
+        m_dk = (m_targetK - m_k) / static_cast<double>(m_rampLength);
+        m_remaining = m_rampLength;
+    }
+
+    inline void StateVariableFilter::updateCoefficients() {
+        m_a1 = 1.0 / (1.0 + m_g * (m_g + m_k));
+        m_a2 = m_g * m_a1;
+        m_a3 = m_g * m_a2;
+    }
+
+    inline void StateVariableFilter::rampLength(size_t length) {
+        m_rampLength = std::max<size_t>(1, length);
+    }
+
+    template<typename SampleType>
+    StateVariableFilter::Outputs StateVariableFilter::tick(SampleType iSample) {
+        if(m_remaining > 0){
+            if(--m_remaining == 0){
+                m_g = m_targetG;
+                m_k = m_targetK;
+            }else {
+                m_g += m_dg;
+                m_k += m_dk;
+            }
+            updateCoefficients();
+        }
+
+        const auto k = m_k;
+        const auto a1 = m_a1;
+        const auto a2 = m_a2;
+        const auto a3 = m_a3;
+
+        const double x = iSample;
+        const auto v3 = x - m_ic2eq;
+        const auto v1 = a1 * m_ic1eq + a2 * v3;
+        const auto v2 = m_ic2eq + a2 * m_ic1eq + a3 * v3;
+        m_ic1eq = 2 * v1 - m_ic1eq;
+        m_ic2eq = 2 * v2 - m_ic2eq;
+        antiDenormal(m_ic1eq);
+        antiDenormal(m_ic2eq);
+
+        return { v2, v1, x - k * v1 - v2 };
+    }
+
+    template<typename SampleType>
+    SampleType StateVariableFilter::lowPass(SampleType iSample) {
+        return static_cast<SampleType>(tick(iSample).lowPass);
+    }
+
+    template<typename SampleType>
+    SampleType StateVariableFilter::bandPass(SampleType iSample) {
+        const auto outputs = tick(iSample);
+        return static_cast<SampleType>(m_k * outputs.bandPass);
+    }
+
+    template<typename SampleType>
+    SampleType StateVariableFilter::highPass(SampleType iSample) {
+        return static_cast<SampleType>(tick(iSample).highPass);
+    }
+
+    inline void StateVariableFilter::reset() {
+        m_ic1eq = 0;
+        m_ic2eq = 0;
+    }
+}
@@ -1,47 +1,233 @@
 #pragma once
 
-#include <string>
-#include <map>
-#include <sstream>
+#include <array>
+#include <list>
+#include <algorithm>
+#include <tuple>
+#include <mutex>
+#include <cmath>
+#include <memory>
+#include <optional>
 #include <functional>
-#include <thread>
+#include <type_traits>
+#include <unordered_map>
 
 namespace dsp {
 
-    static std::map<std::thread::id, std::stringstream> threadLocalSS;
+    inline void hashCombine(size_t& seed, size_t value) {
+        seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    template<typename... Args>
+    struct TupleHash {
+        size_t operator()(const std::tuple<Args...>& key) const {
+            size_t seed = 0;
+            std::apply([&](const auto&... values){
+                (hashCombine(seed, std::hash<std::decay_t<decltype(values)>>{}(values)), ...);
+            }, key);
+            return seed;
+        }
+    };
+
+    /**
+     * Bounded least recently used cache, split into independently locked shards
+     * so lookups from different threads rarely contend.
+     */
+    template<typename Key, typename Value, typename Hash = std::hash<Key>, size_t Shards = 16>
+    class LruCache {
+    public:
+        explicit LruCache(size_t capacity = 1024);
+
+        std::optional<Value> get(const Key& key);
+
+        void put(const Key& key, Value value);
+
+        template<typename Compute>
+        Value getOrCompute(const Key& key, Compute&& compute);
+
+        size_t size() const;
+
+    private:
+        using Entries = std::list<std::pair<Key, Value>>;
+
+        struct Shard {
+            mutable std::mutex mutex;
+            Entries entries;
+            std::unordered_map<Key, typename Entries::iterator, Hash> index;
+        };
+
+        Shard& shard(const Key& key);
+
+    private:
+        std::array<Shard, Shards> m_shards;
+        size_t m_shardCapacity;
+    };
+
+    /**
+     * Caches the results of delegate keyed on its arguments. Floating point arguments
+     * can optionally be quantized to multiples of quantum so nearby values share an entry.
+     * Copies of a Memoized share the same cache and it is safe to call from any thread.
+     */
+    template<typename ReturnType, typename... Args>
+    class Memoized {
+    public:
+        using Key = std::tuple<std::decay_t<Args>...>;
+        using Cache = LruCache<Key, ReturnType, TupleHash<std::decay_t<Args>...>>;
+
+        Memoized(std::function<ReturnType(Args...)> delegate, size_t capacity, double quantum);
+
+        ReturnType operator()(Args... args) const;
+
+        [[nodiscard]]
+        size_t size() const;
+
+    private:
+        template<typename T>
+        T quantize(T value) const;
+
+    private:
+        std::function<ReturnType(Args...)> m_delegate;
+        std::shared_ptr<Cache> m_cache;
+        double m_quantum;
+    };
+
+    /**
+     * Wraps delegate in a Memoized. The argument types are deduced from a function, function
+     * pointer or non generic lambda. Generic (auto) lambdas have none to deduce, so they need
+     * them spelled out, e.g. memorize<double, double, int>([](auto x, auto n){ ... }). ReturnType
+     * defaults to the delegate's own return type.
+     */
+    template<typename ReturnType = void, typename... Args, typename Delegate>
+    auto memorize(Delegate&& delegate, size_t capacity = 1024, double quantum = 0);
+
+//==============================================================================
+//        _        _           _  _
+//     __| |  ___ | |_   __ _ (_)| | ___
+//    / _` | / _ \| __| / _` || || |/ __|
+//   | (_| ||  __/| |_ | (_| || || |\__ \ _  _  _
+//    \__,_| \___| \__| \__,_||_||_||___/(_)(_)(_)
+//
+//   Code beyond this point is implementation detail...
+//
+//==============================================================================
+    template<typename Key, typename Value, typename Hash, size_t Shards>
+    LruCache<Key, Value, Hash, Shards>::LruCache(size_t capacity)
+    : m_shardCapacity{ std::max<size_t>(1, (capacity + Shards - 1) / Shards) }
+    {}
+
+    template<typename Key, typename Value, typename Hash, size_t Shards>
+    typename LruCache<Key, Value, Hash, Shards>::Shard &LruCache<Key, Value, Hash, Shards>::shard(const Key &key) {
+        // the high half is folded into the low half so hashes that differ only in their high bits
+        // still spread across the shards, shifting by half the width is defined for any size_t
+        const size_t hash = Hash{}(key);
+        return m_shards[(hash ^ (hash >> (sizeof(size_t) * 4))) % Shards];
+    }
+
+    template<typename Key, typename Value, typename Hash, size_t Shards>
+    std::optional<Value> LruCache<Key, Value, Hash, Shards>::get(const Key &key) {
+        auto& s = shard(key);
+        std::lock_guard<std::mutex> lk{ s.mutex };
 
-    std::stringstream& getStringStream(){
-        auto id = std::this_thread::get_id();
-        if(threadLocalSS.find(id) == threadLocalSS.end()){
-            threadLocalSS[id] = std::stringstream{};
+        auto itr = s.index.find(key);
+        if(itr == s.index.end()){
+            return {};
+        }
+        if(itr->second != s.entries.begin()){
+            s.entries.splice(s.entries.begin(), s.entries, itr->second);
         }
-        threadLocalSS[id].clear();
-        threadLocalSS[id].str("");
+        return itr->second->second;
+    }
+
+    template<typename Key, typename Value, typename Hash, size_t Shards>
+    void LruCache<Key, Value, Hash, Shards>::put(const Key &key, Value value) {
+        auto& s = shard(key);
+        std::lock_guard<std::mutex> lk{ s.mutex };
 
-        return threadLocalSS[id];
+        if(auto itr = s.index.find(key); itr != s.index.end()){
+            itr->second->second = std::move(value);
+            s.entries.splice(s.entries.begin(), s.entries, itr->second);
+            return;
+        }
+
+        if(s.entries.size() >= m_shardCapacity){
+            s.index.erase(s.entries.back().first);
+            s.entries.pop_back();
+        }
+        s.entries.emplace_front(key, std::move(value));
+        s.index.emplace(key, s.entries.begin());
     }
 
-    void concatenate(std::stringstream&){}
+    template<typename Key, typename Value, typename Hash, size_t Shards>
+    template<typename Compute>
+    Value LruCache<Key, Value, Hash, Shards>::getOrCompute(const Key &key, Compute &&compute) {
+        if(auto value = get(key)){
+            return std::move(*value);
+        }
+        // computed outside the shard lock, a racing thread may compute the same value once more
+        Value value = compute();
+        put(key, value);
+        return value;
+    }
 
-    template<typename T, typename... Args>
-    void concatenate(std::stringstream& ss, T value, Args... args){
-        ss << value << (sizeof...(args) > 0 ?  "_" : "");
-        concatenate(ss, args...);
+    template<typename Key, typename Value, typename Hash, size_t Shards>
+    size_t LruCache<Key, Value, Hash, Shards>::size() const {
+        size_t total = 0;
+        for(auto& s : m_shards){
+            std::lock_guard<std::mutex> lk{ s.mutex };
+            total += s.entries.size();
+        }
+        return total;
     }
 
-    template<typename ReturnType, typename Delegate>
-    auto memorize(Delegate&& delegate) {
+    template<typename ReturnType, typename... Args>
+    Memoized<ReturnType, Args...>::Memoized(std::function<ReturnType(Args...)> delegate, size_t capacity, double quantum)
+    : m_delegate{ std::move(delegate) }
+    , m_cache{ std::make_shared<Cache>(capacity) }
+    , m_quantum{ quantum }
+    {}
 
-        return [delegate, cache=std::map<std::string, ReturnType>{}] (auto... args) mutable {
-            auto& ss = getStringStream();
-            concatenate(ss, args...);
-            auto key = ss.str();
-            if(cache.find(key) != cache.end()){
-                return cache[key];
+    template<typename ReturnType, typename... Args>
+    template<typename T>
+    T Memoized<ReturnType, Args...>::quantize(T value) const {
+        if constexpr (std::is_floating_point_v<T>){
+            if(m_quantum > 0){
+                return static_cast<T>(std::round(value / m_quantum) * m_quantum);
             }
-            auto result = delegate(args...);
-            cache[key] = result;
-            return result;
+        }
+        return value;
+    }
+
+    template<typename ReturnType, typename... Args>
+    ReturnType Memoized<ReturnType, Args...>::operator()(Args... args) const {
+        // the delegate sees the quantized arguments too, so every call in a bucket gets the same result
+        const Key key{ quantize(args)... };
+        return m_cache->getOrCompute(key, [&]{ return std::apply(m_delegate, key); });
+    }
+
+    template<typename ReturnType, typename... Args>
+    size_t Memoized<ReturnType, Args...>::size() const {
+        return m_cache->size();
+    }
+
+    namespace details {
+        template<typename ReturnType, typename Signature>
+        struct MemoizedOf;
+
+        template<typename ReturnType, typename R, typename... Args>
+        struct MemoizedOf<ReturnType, std::function<R(Args...)>> {
+            using type = Memoized<std::conditional_t<std::is_void_v<ReturnType>, R, ReturnType>, Args...>;
         };
     }
-}
\ No newline at end of file
+
+    template<typename ReturnType, typename... Args, typename Delegate>
+    auto memorize(Delegate&& delegate, size_t capacity, double quantum) {
+        if constexpr (sizeof...(Args) == 0){
+            using Function = decltype(std::function{ delegate });
+            using Memo = typename details::MemoizedOf<ReturnType, Function>::type;
+            return Memo{ std::forward<Delegate>(delegate), capacity, quantum };
+        }else {
+            using Result = std::conditional_t<std::is_void_v<ReturnType>, std::invoke_result_t<Delegate&, Args...>, ReturnType>;
+            return Memoized<Result, Args...>{ std::forward<Delegate>(delegate), capacity, quantum };
+        }
+    }
+}
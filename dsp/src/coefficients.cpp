@@ -0,0 +1,11 @@
+#include "dsp/coefficients.h"
+
+namespace dsp {
+
+    template struct Coefficients<2, float>;
+    template struct Coefficients<2, double>;
+    template struct Coefficients<4, float>;
+    template struct Coefficients<4, double>;
+    template struct Coefficients<6, float>;
+    template struct Coefficients<6, double>;
+}
@@ -3,6 +3,8 @@
 
 #include <cstdint>
 #include <dsp/recursive_filters.h>
+#include <dsp/state_variable_filter.h>
+#include <dsp/oversampler.h>
 #include <random>
 #include <functional>
 #include <audio/choc_Oscillators.h>
@@ -114,7 +116,7 @@ class WindGenerator{
 public:
     explicit WindGenerator(uint32_t sampleRate = 0)
     : m_windSpeed{ sampleRate }
-    , m_bp{ dsp::recursive::bandPassFilter(800.0f/sampleRate, 0.01) }
+    , m_bp{ dsp::recursive::bandPassFilter<float>(800.0f/sampleRate, 0.01) }
     , m_noise{whiteNoise()}
     {}
 
@@ -128,7 +130,7 @@ public:
 
 private:
     WindSpeed m_windSpeed{};
-    dsp::BiQuad m_bp;
+    dsp::FloatBiQuad m_bp;
     WhiteNoise m_noise;
 };
 
@@ -139,7 +141,7 @@ public:
     , m_period{ 1/static_cast<float>(sampleRate) }
     , m_delay{ delay / static_cast<float>(sampleRate) }
     , m_windSpeed{ sampleRate }
-    , m_bp{ }
+    , m_bp{ ControlRate }
     , m_noise{whiteNoise()}
     , m_lower{ lower }
     , m_upper{ upper }
@@ -154,23 +156,26 @@ public:
             return 0;
         }
         auto ws = m_windSpeed.getSample();
-        auto fc = ws * m_lower + m_upper;
-        fc /= m_sampleRate;
-        auto bw = 60.f/m_sampleRate;
-        auto bp = dsp::recursive::bandPassFilter(fc, bw);
-        m_bp.a = bp.a;
-        m_bp.b = bp.b;
-
-        auto sample = m_bp(m_noise());
+        if(m_controlCounter++ % ControlRate == 0) {
+            auto fc = ws * m_lower + m_upper;
+            fc /= m_sampleRate;
+            auto bw = 60.f/m_sampleRate;
+            m_bp.set(fc, fc / bw);
+        }
+
+        auto sample = m_bp.bandPass(m_noise());
         sample *= (ws + m_offset) * (ws + m_offset);
         sample *= m_scale;
         return sample;
     }
 
 private:
+    static constexpr uint32_t ControlRate = 32;
+
     WindSpeed m_windSpeed{};
-    dsp::BiQuad m_bp;
+    dsp::StateVariableFilter m_bp;
     WhiteNoise m_noise;
+    uint32_t m_controlCounter{0};
     float m_delay{};
     float m_period;
     float m_sampleRate{};
@@ -186,8 +191,8 @@ public:
     : m_delay{ 3000.f/static_cast<float>(sampleRate) }
     , m_period{ 0.07f/static_cast<float>(sampleRate) }
     , m_lopL{ dsp::recursive::lowPassFilter<2>(0.1f/static_cast<float>(sampleRate)) }
-    , m_lopH{ dsp::recursive::lowPassFilter<2>(4000.f/static_cast<float>(sampleRate)) }
-    , m_hip{ dsp::recursive::highPassFilter<2>(200.f/static_cast<float>(sampleRate)) }
+    , m_lopH{ dsp::recursive::lowPassFilter<2, float>(4000.f/static_cast<float>(sampleRate)) }
+    , m_hip{ dsp::recursive::highPassFilter<2, float>(200.f/static_cast<float>(sampleRate)) }
     , m_noise( whiteNoise() )
     , m_windSpeed( sampleRate )
     {}
@@ -200,7 +205,8 @@ public:
         }
         auto wind = m_lopL(m_windSpeed.getSample() + 0.3f);
         auto sample = 1.f - (wind * 0.4f);
-        sample = (std::max(m_noise(), sample) - sample) * sample;
+        // the clip and square alias at the base rate, run them at twice the rate
+        sample = m_oversampler.process(sample, [&](float s){ return (std::max(m_noise(), s) - s) * s; });
         sample = m_lopH(m_hip(sample));
         sample *= (wind - 0.2f) * 0.8f;
 
@@ -209,10 +215,11 @@ public:
 
 private:
     float m_delay{};
-    dsp::BiQuad m_lopL;
-    dsp::BiQuad m_lopH;
-    dsp::BiQuad m_hip;
+    dsp::BiQuad m_lopL;     // sub audio cutoff, needs double coefficients to stay stable
+    dsp::FloatBiQuad m_lopH;
+    dsp::FloatBiQuad m_hip;
     WhiteNoise m_noise;
+    dsp::Oversampler<float> m_oversampler{ 2 };
     WindSpeed m_windSpeed{};
     float m_period;
 };
@@ -223,7 +230,7 @@ public:
     : m_sampleRate{ static_cast<float>(sampleRate)}
     , m_clip{std::move(clip)}
     , m_lop( dsp::recursive::lowPassFilter<2>(lopCF/static_cast<float>(sampleRate)))
-    , m_bp{ dsp::recursive::bandPassFilter( bpCF / static_cast<float>(sampleRate), bpBW / static_cast<float>(sampleRate) ) }
+    , m_bp{ dsp::recursive::bandPassFilter<float>( bpCF / static_cast<float>(sampleRate), bpBW / static_cast<float>(sampleRate) ) }
     , m_delay{ delay / static_cast<float>(sampleRate) }
     , m_period{ 1/static_cast<float>(sampleRate) }
     , m_offset0{ offset0 }
@@ -254,7 +261,7 @@ public:
 
 private:
     dsp::BiQuad m_lop;
-    dsp::BiQuad m_bp;
+    dsp::FloatBiQuad m_bp;
     Range m_clip;
     float m_offset0;
     float m_scale;
@@ -1,4 +1,5 @@
 #include <kfr/all.hpp>
+#include <dsp/recursive_filters.h>
 
 
 int main(int, char**){
@@ -13,5 +14,16 @@ int main(int, char**){
     plot_save("chebyshev1_lowpass8", output,
               options + ", title='8th-order Chebyshev type I filter, lowpass'");
 
+    // same design from dsp's second order sections, kfr's frequency is relative to nyquist
+    // and its ripple is in dB, dsp expects a fraction of the sample rate and percent ripple
+    const auto ripple = 100.0 * (1.0 - std::pow(10.0, -2.0 / 20.0));
+    auto cascade = dsp::recursive::chebyshev::computeSections<8>(dsp::FilterType::LowPass, ripple, 0.09 * 0.5);
+
+    univector<fbase, 1024> impulse = unitimpulse();
+    univector<fbase, 1024> dspOutput;
+    cascade.process(impulse.data(), dspOutput.data(), impulse.size());
+    plot_save("dsp_chebyshev1_lowpass8", dspOutput,
+              options + ", title='8th-order Chebyshev type I filter, lowpass (dsp sections)'");
+
     return 0;
 }
\ No newline at end of file
@@ -7,7 +7,7 @@
 #include <cassert>
 #include <cstdlib>
 #include <cstdio>
-#include "synthesizer.h"
+#include "midi_reader.h"
 #include <audio/engine.h>
 #include <vui/vui.h>
 #include <imgui.h>
@@ -54,8 +54,6 @@ void close(PmStream* midi){
 int main(int, char**){
     auto midi = initMidi();
 
-    PmEvent event;
-
     audio::Engine engine{{0, 1, audio::SampleType::Float32, SAMPLE_RATE, FRAME_COUNT, 4096}};
     engine.start();
     printf("audio engine online\n");
@@ -105,16 +103,10 @@ int main(int, char**){
 
     }, [&]{ engine.shutdown(); });
 
-    while (engine.isActive()) {
-        if (Pm_Poll(midi) == TRUE) {
-            auto length = static_cast<PmError>(Pm_Read(midi, &event, 1));
-            if (length > 0) {
-                synthesizer.addEvent(event);
-            }
-        }
-    }
+    MidiReader reader{ midi, [&](PmEvent event){ synthesizer.addEvent(event); } };
 
     vui::wait();
+    reader.stop();
 
     close(midi);
     return 0;
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <portmidi.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+
+/**
+ * Reads a PortMidi input on its own thread and hands every event to onEvent. PortMidi has no
+ * blocking read, so while the input is quiet the thread sleeps between polls instead of spinning,
+ * which costs at most a millisecond of latency on the first event after a pause.
+ */
+class MidiReader {
+public:
+    MidiReader(PmStream* stream, std::function<void(PmEvent)> onEvent);
+
+    ~MidiReader();
+
+    MidiReader(const MidiReader&) = delete;
+
+    MidiReader& operator=(const MidiReader&) = delete;
+
+    void stop();
+
+private:
+    void read();
+
+private:
+    PmStream* m_stream;
+    std::function<void(PmEvent)> m_onEvent;
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+};
+
+MidiReader::MidiReader(PmStream *stream, std::function<void(PmEvent)> onEvent)
+: m_stream{ stream }
+, m_onEvent{ std::move(onEvent) }
+, m_thread{ &MidiReader::read, this }
+{}
+
+MidiReader::~MidiReader() {
+    stop();
+}
+
+void MidiReader::stop() {
+    m_running = false;
+    if(m_thread.joinable()){
+        m_thread.join();
+    }
+}
+
+void MidiReader::read() {
+    using namespace std::chrono_literals;
+    std::array<PmEvent, 64> events{};
+
+    while(m_running){
+        if(Pm_Poll(m_stream) != TRUE){
+            std::this_thread::sleep_for(1ms);
+            continue;
+        }
+
+        const auto count = Pm_Read(m_stream, events.data(), static_cast<int32_t>(events.size()));
+        for(auto i = 0; i < count; i++){
+            m_onEvent(events[i]);
+        }
+    }
+}
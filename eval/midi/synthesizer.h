@@ -1,7 +1,7 @@
 #pragma once
 
 #include <thread>
-#include <dsp/ring_buffer.h>
+#include <dsp/event_queue.h>
 #include <cmath>
 #include <audio/patch_input.h>
 #include <portmidi.h>
@@ -14,6 +14,8 @@
 #include <dsp/recursive_filters.h>
 #include <dsp/fourier/series.h>
 #include <random>
+#include <atomic>
+#include <limits>
 
 enum class OscillatorType : int { Sine = 0, Square, Saw, Triangle };
 
@@ -62,20 +64,49 @@ struct Note{
     }
 };
 
+// anything that changes the synthesizer, queued so any thread can send it
+struct SynthEvent {
+    enum class Type : int { Midi = 0, Oscillator };
+
+    Type type{Type::Midi};
+    PmEvent midi{};
+    OscillatorType oscillator{OscillatorType::Sine};
+};
+
 class Synthesizer{
 public:
     explicit Synthesizer(const audio::PatchInput& patch, float sampleRate);
 
     ~Synthesizer();
 
+    /**
+     * safe from any thread, the event takes effect on the next sample rendered
+     */
     void addEvent(PmEvent event);
 
+    /**
+     * safe from any thread, the event takes effect at sampleTime on the synthesizer's sample clock
+     */
+    void addEvent(PmEvent event, uint64_t sampleTime);
+
+    /**
+     * safe from any thread
+     */
     void set(OscillatorType oscillator);
 
     void run();
 
+    [[nodiscard]]
+    uint64_t sampleClock() const;
+
 private:
-    int processEvents();
+    void send(uint64_t time, SynthEvent event);
+
+    void render(float* output, size_t numSamples);
+
+    void handle(const SynthEvent& event);
+
+    void handleMidi(PmEvent event);
 
     float nextSample();
 
@@ -85,7 +116,9 @@ private:
     std::array<Note, 88> m_notes;
     audio::PatchInput m_patch;
     std::thread m_thread;
-    dsp::RingBuffer<PmEvent, 512> m_events;
+    dsp::EventQueue<SynthEvent, 512> m_events;
+    std::atomic<uint64_t> m_sampleClock{0};
+    std::atomic<bool> m_running{true};
     dsp::BiQuad m_lop;
     float m_period{0};
     static constexpr int mOffset = 21;
@@ -111,13 +144,33 @@ Synthesizer::Synthesizer(const audio::PatchInput& patch, float sampleRate)
 }
 
 Synthesizer::~Synthesizer() {
+    m_running = false;
+    m_events.wake();
     if(m_thread.joinable()){
         m_thread.join();
     }
 }
 
 void Synthesizer::addEvent(PmEvent event) {
-    m_events.push(event);
+    addEvent(event, sampleClock());
+}
+
+void Synthesizer::addEvent(PmEvent event, uint64_t sampleTime) {
+    send(sampleTime, SynthEvent{ SynthEvent::Type::Midi, event });
+}
+
+void Synthesizer::set(OscillatorType oscillator) {
+    send(sampleClock(), SynthEvent{ SynthEvent::Type::Oscillator, {}, oscillator });
+}
+
+void Synthesizer::send(uint64_t time, SynthEvent event) {
+    if(!m_events.push(time, event)){
+        printf("event queue full, event dropped\n");
+    }
+}
+
+uint64_t Synthesizer::sampleClock() const {
+    return m_sampleClock.load(std::memory_order_acquire);
 }
 
 
@@ -127,13 +180,17 @@ void Synthesizer::run() {
         audio::CircularAudioBuffer<float> buffer(64);
         std::vector<float> transferBuf;
 
-        while(m_patch.isOpen()){
-            processEvents();
-
-            if(!notePressed()) continue;
+        while(m_running && m_patch.isOpen()){
+            if(!notePressed()){
+                // nothing is rendered while silent, so the clock stands still and every event is due,
+                // sleep until one arrives instead of spinning
+                m_events.wait();
+                m_events.drain(std::numeric_limits<uint64_t>::max(), [this](const auto& event){ handle(event.payload); });
+                continue;
+            }
 
             transferBuf.resize(buffer.remainder());
-            std::generate(transferBuf.begin(), transferBuf.end(), [this]{ return nextSample(); });
+            render(transferBuf.data(), transferBuf.size());
             buffer.push(transferBuf.data(), transferBuf.size());
 
             transferBuf.resize(buffer.num());
@@ -149,33 +206,65 @@ void Synthesizer::run() {
     m_thread = std::move(thread);
 }
 
-int Synthesizer::processEvents() {
-    int numEvents = m_events.size();
-    while(auto oEvent = m_events.poll()){
-        auto msg = oEvent->message;
-        int status = Pm_MessageStatus(msg);
+void Synthesizer::render(float *output, size_t numSamples) {
+    const auto start = m_sampleClock.load(std::memory_order_relaxed);
+    size_t rendered = 0;
 
-        if(status != 0x80 && status != 0x90){
-            // we only care about channel one for now
-            continue;
+    // events arrive in time order and split the block, so each one lands on its own sample
+    m_events.drain(start + numSamples, [&](const auto& event){
+        const auto at = static_cast<size_t>(std::max(event.time, start) - start);
+        for(; rendered < at; rendered++){
+            output[rendered] = nextSample();
         }
+        handle(event.payload);
+    });
+    for(; rendered < numSamples; rendered++){
+        output[rendered] = nextSample();
+    }
+
+    m_sampleClock.store(start + numSamples, std::memory_order_release);
+}
+
+void Synthesizer::handle(const SynthEvent &event) {
+    switch(event.type){
+        case SynthEvent::Type::Midi:
+            handleMidi(event.midi);
+            break;
+        case SynthEvent::Type::Oscillator:
+            for(auto& note : m_notes){
+                note.osc.type = event.oscillator;
+            }
+            break;
+    }
+}
 
-        int mPitch = Pm_MessageData1(msg);
-        int velocity = Pm_MessageData2(msg);
+void Synthesizer::handleMidi(PmEvent event) {
+    auto msg = event.message;
+    int status = Pm_MessageStatus(msg);
 
-        int noteId = mPitch - mOffset;
-        m_notes[noteId].state = static_cast<Note::State>((status >> 4) & 1);
+    if(status != 0x80 && status != 0x90){
+        // we only care about channel one for now
+        return;
+    }
 
-        if(m_notes[noteId].state == Note::State::ON){
-            m_notes[noteId].loudness = static_cast<float>(velocity)/127.f;    // FIXME use decibels
-        }
+    int mPitch = Pm_MessageData1(msg);
+    int velocity = Pm_MessageData2(msg);
 
-        if(m_notes[noteId].state == Note::State::OFF){
-            m_notes[noteId].t = 0;
-        }
-        printf("note p: %d, v: %d, s:%d\n", mPitch, velocity, ((status >> 4) & 1));
+    int noteId = mPitch - mOffset;
+    if(noteId < 0 || noteId >= static_cast<int>(m_notes.size())){
+        return;
     }
-    return numEvents;
+
+    m_notes[noteId].state = static_cast<Note::State>((status >> 4) & 1);
+
+    if(m_notes[noteId].state == Note::State::ON){
+        m_notes[noteId].loudness = static_cast<float>(velocity)/127.f;    // FIXME use decibels
+    }
+
+    if(m_notes[noteId].state == Note::State::OFF){
+        m_notes[noteId].t = 0;
+    }
+    printf("note p: %d, v: %d, s:%d\n", mPitch, velocity, ((status >> 4) & 1));
 }
 
 float Synthesizer::nextSample() {
@@ -201,8 +290,3 @@ bool Synthesizer::notePressed() const {
     return std::any_of(m_notes.begin(), m_notes.end(), [](auto& n){ return n.isOn(); });
 }
 
-void Synthesizer::set(OscillatorType oscillator) {
-    for(auto& note : m_notes){
-        note.osc.type = oscillator;
-    }
-}
@@ -10,7 +10,9 @@
 #include <imgui.h>
 #include <implot.h>
 #include <numeric>
+#include <algorithm>
 #include <dsp/fft.h>
+#include <dsp/cic.h>
 #include "helper.h"
 
 int main(int, char**){
@@ -54,6 +56,12 @@ int main(int, char**){
         static std::vector<float> fft(fftSampleRate);
         static std::vector<float> x(frameSize);
 
+        // rectified output reduced 100x for the level trend, the newest value at the back
+        static dsp::CicDecimator<4> levelDecimator(100, 5);
+        static std::vector<float> rectified(frameSize);
+        static std::vector<float> decimated(frameSize);
+        static std::vector<float> level(1024);
+
 
         std::iota(x.begin(), x.end(), 1.f);
         std::transform(x.begin(), x.end(), x.begin(), [](auto v){ return v * period; });
@@ -69,6 +77,12 @@ int main(int, char**){
                 computeFFT(signal, fft, sampleRate, fftSampleRate);
             }
             sid %= signal.capacity();
+
+            const auto numRead = static_cast<size_t>(std::max(read, 0));
+            std::transform(buffer.begin(), buffer.begin() + numRead, rectified.begin(), [](auto v){ return std::abs(v); });
+            const auto count = levelDecimator.process(rectified.data(), numRead, decimated.data());
+            std::shift_left(level.begin(), level.end(), static_cast<std::ptrdiff_t>(count));
+            std::copy_n(decimated.begin(), count, level.end() - static_cast<std::ptrdiff_t>(count));
         }
 
         // graphs
@@ -77,14 +91,18 @@ int main(int, char**){
         ImGui::SetWindowSize({1400, 1080});
         ImGui::SetWindowPos({0, 0});
 
-        if(ImPlot::BeginPlot("wave", {1400, 500})){
+        if(ImPlot::BeginPlot("wave", {1400, 330})){
             ImPlot::PlotLine("sinewave", x.data(), buffer.data(), read);
             ImPlot::EndPlot();
         }
-        if(ImPlot::BeginPlot("fft", {1400, 500})){
+        if(ImPlot::BeginPlot("fft", {1400, 330})){
             ImPlot::PlotLine("magnitude", fft.data(), 1000);
             ImPlot::EndPlot();
         }
+        if(ImPlot::BeginPlot("level", {1400, 330})){
+            ImPlot::PlotLine("level", level.data(), static_cast<int>(level.size()));
+            ImPlot::EndPlot();
+        }
 
         ImGui::End();
 
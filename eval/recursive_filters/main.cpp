@@ -3,6 +3,7 @@
 #include <imgui.h>
 #include <implot.h>
 #include <dsp/fft.h>
+#include <dsp/frequency_response.h>
 #include <array>
 #include <iostream>
 #include <dsp/ring_buffer.h>
@@ -37,7 +38,7 @@ using Signal = dsp::SampleBuffer<double>;
 
 struct Data{
     Signal impulseResponse;
-    Signal frequencyResponse;
+    dsp::FrequencyResponse frequencyResponse;
     Signal sFrequencyResponse;
 };
 
@@ -72,32 +73,25 @@ void computeFFT(Signal& signal, Signal& output, int nFrequency){
 
 
 
-Signal applyFilter(const Signal& input, float frequency, float bandwidth, float gain, int filterType){
-    Signal output;
-
+dsp::BiQuad designFilter(float frequency, float bandwidth, float gain, int filterType){
     if(filterType == BAND_PASS){
-        auto filter = dsp::recursive::bandPassFilter(frequency, bandwidth);
-        output = filter(input);
+        return dsp::recursive::bandPassFilter(frequency, bandwidth);
     }else if(filterType == BAND_REJECT){
-        auto filter = dsp::recursive::bandRejectFilter(frequency, bandwidth);
-        output = filter(input);
+        return dsp::recursive::bandRejectFilter(frequency, bandwidth);
     }else if(filterType == LOW_PASS){
-        auto filter = dsp::recursive::lowPassFilter<2>(frequency);
-        output = filter(input);
+        return dsp::recursive::lowPassFilter<2>(frequency);
     }else if(filterType == HIGH_PASS){
-        auto filter = dsp::recursive::highPassFilter<2>(frequency);
-        output = filter(input);
+        return dsp::recursive::highPassFilter<2>(frequency);
     }else if(filterType == LOW_SHELF){
-        auto filter = dsp::recursive::lowShelf(frequency, gain);
-        output = filter(input);
+        return dsp::recursive::lowShelf(frequency, gain);
     }else if(filterType == HIGH_SHELF){
-        auto filter = dsp::recursive::highShelf(frequency, gain);
-        output = filter(input);
+        return dsp::recursive::highShelf(frequency, gain);
     }else if(filterType == PEAKING_FILTER){
-        auto filter = dsp::recursive::peakingFilter(frequency, gain, bandwidth);
-        output = filter(input);
+        return dsp::recursive::peakingFilter(frequency, gain, bandwidth);
     }
-    return output;
+    dsp::BiQuad identity{};
+    identity.a0 = 1;
+    return identity;
 }
 
 
@@ -106,18 +100,12 @@ Data createDate(Settings settings){
     Signal impulse(N);
     impulse[N/2] = 1;
 
-    Signal impulseResponse = applyFilter(impulse, settings.frequency, settings.bandwidth
-                                         , settings.gain, settings.filterType);
-
-    std::vector<std::complex<double>> freq(N);
+    auto filter = designFilter(settings.frequency, settings.bandwidth, settings.gain, settings.filterType);
+    const auto frequencyResponse = dsp::frequencyResponse(filter, dsp::linearFrequencies(N));
 
-    dsp::fft(impulseResponse.begin(), impulseResponse.end(), freq.begin(), N);
-    dsp::SampleBuffer<double> freqMag;
-    for(const auto& c : freq){
-        freqMag.add(abs(c));
-    }
+    Signal impulseResponse = filter(impulse);
 
-    return { impulseResponse, freqMag };
+    return { impulseResponse, frequencyResponse };
 }
 
 struct Channels{
@@ -285,7 +273,8 @@ int main(int, char**){
         }
 
         if(ImPlot::BeginPlot("Frequency Response", {500, 500})){
-            ImPlot::PlotLine("FFT", data.frequencyResponse.data(), data.frequencyResponse.size()/2);
+            const auto& response = data.frequencyResponse;
+            ImPlot::PlotLine("Magnitude", response.frequency.data(), response.magnitude.data(), response.size());
             ImPlot::EndPlot();
         }
 
@@ -4,6 +4,8 @@
 #include <audio/choc_Oscillators.h>
 #include <audio/choc_AudioFileFormat_WAV.h>
 #include <dsp/recursive_filters.h>
+#include <dsp/sample_buffer.h>
+#include <dsp/mapped_sample_buffer.h>
 #include <algorithm>
 #include <numeric>
 #include <implot.h>
@@ -42,38 +44,47 @@ std::vector<float> wind(std::chrono::seconds duration, int sampleRate) {
 //             + howls0.getSample() + howls1.getSample() + treeLeaves.getSample();
 //    });
 
-    auto size = duration.count() * sampleRate;
+    const auto size = static_cast<size_t>(duration.count() * sampleRate);
+    constexpr size_t BlockSize = FRAME_COUNT;
 
-    float left{}, right{};
-    std::vector<float> wind{};
-    for(int i = 0; i < size; i++){
-        auto channels  = audio::fcpan(windGenerator.getSample(), 0.51);
-        left = std::get<0>(channels);
-        right = std::get<1>(channels);
-
-        channels = audio::fcpan(wh0.getSample(), 0.28);
-        left += std::get<0>(channels);
-        right += std::get<1>(channels);
-
-        channels = audio::fcpan(wh1.getSample(), 0.64);
-        left += std::get<0>(channels);
-        right += std::get<1>(channels);
+    // every source is panned with a constant gain, so the sources are rendered a block at a time
+    // and both channels are mixed in one pass each
+    const auto [windLeft, windRight] = audio::fcpan(1, 0.51);
+    const auto [wh0Left, wh0Right] = audio::fcpan(1, 0.28);
+    const auto [wh1Left, wh1Right] = audio::fcpan(1, 0.64);
+    const auto [leavesLeft, leavesRight] = audio::fcpan(1, 0.51);
+    const auto [howls0Left, howls0Right] = audio::fcpan(1, 0.91);
+    const auto [howls1Left, howls1Right] = audio::fcpan(1, 0.03);
 
-        channels = audio::fcpan(treeLeaves.getSample(), 0.51);
-        left += std::get<0>(channels);
-        right += std::get<1>(channels);
+    dsp::SampleBuffer<float> windBlock(BlockSize), wh0Block(BlockSize), wh1Block(BlockSize);
+    dsp::SampleBuffer<float> leavesBlock(BlockSize), howls0Block(BlockSize), howls1Block(BlockSize);
+    dsp::SampleBuffer<float> left(BlockSize), right(BlockSize);
 
-        channels = audio::fcpan(howls0.getSample(), 0.91);
-        left += std::get<0>(channels);
-        right += std::get<1>(channels);
-
-        channels = audio::fcpan(howls1.getSample(), 0.03);
-        left += std::get<0>(channels);
-        right += std::get<1>(channels);
+    std::vector<float> wind{};
+    wind.reserve(2 * size);
+    for(size_t offset = 0; offset < size; offset += BlockSize){
+        const auto N = std::min(BlockSize, size - offset);
+        for(auto block : {&windBlock, &wh0Block, &wh1Block, &leavesBlock, &howls0Block, &howls1Block}){
+            block->resize(N);
+        }
+        for(size_t i = 0; i < N; i++){
+            windBlock[i] = windGenerator.getSample();
+            wh0Block[i] = wh0.getSample();
+            wh1Block[i] = wh1.getSample();
+            leavesBlock[i] = treeLeaves.getSample();
+            howls0Block[i] = howls0.getSample();
+            howls1Block[i] = howls1.getSample();
+        }
 
-        wind.push_back(left);
-        wind.push_back(right);
+        left = windBlock * windLeft + wh0Block * wh0Left + wh1Block * wh1Left
+                + leavesBlock * leavesLeft + howls0Block * howls0Left + howls1Block * howls1Left;
+        right = windBlock * windRight + wh0Block * wh0Right + wh1Block * wh1Right
+                + leavesBlock * leavesRight + howls0Block * howls0Right + howls1Block * howls1Right;
 
+        for(size_t i = 0; i < N; i++){
+            wind.push_back(left[i]);
+            wind.push_back(right[i]);
+        }
     }
 
     return wind;
@@ -84,18 +95,13 @@ int main(int, char**){
     using namespace std::chrono_literals;
 
     std::string audioPath = "../../../../resources/voice.wav";
-    std::shared_ptr<std::istream> audioStream = std::make_shared<std::ifstream>(audioPath, std::ios::binary);
-
-    choc::audio::WAVAudioFileFormat<false> audioFileFormat{};
-    auto reader = audioFileFormat.createReader(audioStream);
-    auto props = reader->getProperties();
 
-    auto fileBuffer = reader->readEntireStream<float>();
-    auto iterator = fileBuffer.getIterator(0);
-    std::vector<float> data{iterator.sample, iterator.sample + fileBuffer.getSize().getFrameRange().size()};
+    // mapped rather than decoded, only the header is read until samples are touched
+    auto voice = dsp::MappedSampleBuffer<int16_t>::wav(audioPath);
+    std::vector<float> data{};
 
-    std::cout << "numFrames: " << fileBuffer.getNumFrames() << "\n";
-    std::cout << "numChannels: " << fileBuffer.getNumChannels() << "\n";
+    std::cout << "numFrames: " << voice.numFrames() << "\n";
+    std::cout << "numChannels: " << voice.numChannels() << "\n";
 
     float width = 1024;
     float height = 720;
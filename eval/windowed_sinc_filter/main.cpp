@@ -103,7 +103,7 @@ Data create(Settings settings){
 
     if(settings.applyFilter){
         dsp::SampleBuffer<double> buffer{data.signal.begin(), data.signal.end()};
-        buffer = filter.apply(buffer);
+        filter.apply(buffer, buffer);
         data.signal = std::vector<double>{buffer.begin(), buffer.end()};
     }
 